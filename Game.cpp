@@ -7,510 +7,447 @@
 #include "particle_generator.h"
 #include "postprocessor.h"
 #include "power_up.h"
-#include "irrKlang.h"
 #include "text_renderer.h"
-
+#include "asset_loader.h"
+#include "resolution_controller.h"
+#include "static_layer.h"
+#include "brick_renderer.h"
+#include "globals_buffer.h"
+#include "stream_buffer.h"
+#include "render_queue.h"
+#include "job_system.h"
+#include "sound_bank.h"
+#include "audio_device.h"
+
+#include <chrono>
+#include <iterator>
+#include <iostream>
 #include <sstream>
 
-using namespace irrklang;
-
 // Game related State data
 SpriteRenderer		*Renderer;
-GameObject			*Player;
 ParticleGenerator	*Particles;
 PostProcessor		*Effects;
-ISoundEngine		*SoundEngine = createIrrKlangDevice();
+AudioDevice			*Speaker;
+SoundBank			*Audio;
 TextRenderer		*Text;
-
-const glm::vec2 INITIAL_BALL_VELOCITY(100.0f, -350.0f);
-const float BALL_RADIUS = 12.5f;
-
-float ShakeTime = 0.0f;
-
-typedef std::tuple<bool, Direction, glm::vec2> Collision;
-
-BallObject* Ball;
+AssetLoader			*Loader;
+ResolutionController *Resolution;
+StaticLayer			*Static;
+BrickRenderer		*Blocks;
+GlobalsBuffer		*Globals;
+StreamBuffer		*Stream;
+RenderQueue			*Queue;
+JobSystem			*Jobs;
+
+const double TEXTURE_UPLOAD_BUDGET_MS = 4.0; // GL upload time spent per frame while loading
+const double MAX_SIMULATION_LAG_MS = 250.0;	 // a simulation further behind than this skips ahead instead of catching up
 
 Game::Game(unsigned int width, unsigned int height)
-	: State(GAME_MENU), Keys(), Width(width), Height(height), Lives(3)
+	: World(nullptr), Keys(), Width(width), Height(height), AntiAliasingMode(AA_MSAA_4X), RenderScale(1.0f),
+	TargetFps(60.0f), TickRate(SIM_TICK_RATE), Autoplay(false), AudioMode(AUDIO_IRRKLANG), AudioFile(nullptr), keysPressed(), inputTime(0.0), droppedInputs(0), loading(false), simulating(false)
 {
 }
 
 Game::~Game()
 {
+	this->StopSimulation();
+	// headless runs (batch, soak, audio) never step or draw this game, so there is nothing to report
+	if (this->SimTimes.Samples > 0 || this->RenderTimes.Samples > 0)
+		std::cout << "GAME: simulation " << this->SimTimes.AverageMs() << " ms avg, " << this->SimTimes.WorstMs << " ms worst over "
+			<< this->SimTimes.Samples << " steps; render " << this->RenderTimes.AverageMs() << " ms avg, "
+			<< this->RenderTimes.WorstMs << " ms worst over " << this->RenderTimes.Samples << " frames" << std::endl;
+	if (this->droppedInputs > 0)
+		std::cout << "GAME: dropped " << this->droppedInputs << " input events, the input queue was full" << std::endl;
+	delete this->World;
 	delete Renderer;
-	delete Player;
-	delete Ball;
 	delete Particles;
+	if (Effects)
+		Effects->PrintTimings();
+	if (Stream)
+		Stream->PrintStats();
+	if (Queue)
+		Queue->PrintStats();
+	if (Static)
+		std::cout << "STATIC_LAYER: redrawn " << Static->Rebuilds << " times" << std::endl;
 	delete Effects;
-	SoundEngine->drop();
+	delete Loader;
+	delete Resolution;
+	delete Static;
+	delete Blocks;
+	delete Globals;
+	delete Stream;
+	delete Queue;
+	delete Jobs; // after everything that may still have jobs in flight
+	if (Audio)
+		Audio->PrintStats();
+	if (Speaker)
+		Speaker->PrintStats();
+	delete Audio; // before the device its voices play on
+	delete Speaker;
 }
 
-void Game::Init()
+bool Game::Init()
 {
-	ResourceManager::LoadShader("shaders/sprite.vs", "shaders/sprite.frag", nullptr, "sprite");
-	ResourceManager::LoadShader("shaders/particle.vs", "shaders/particle.frag", nullptr, "particle");
-	ResourceManager::LoadShader("shaders/postprocessing.vs", "shaders/postprocessing.frag", nullptr, "postprocessing");
+	// load every shader up front; a missing or broken asset stops the game here instead of mid-play
+	if (!ResourceManager::LoadShaders())
+	{
+		std::cout << "ERROR::GAME: Failed to load shaders" << std::endl;
+		return false;
+	}
+	// textures are decoded in the background while the loading screen runs; their names
+	// are reserved now so the objects created below can already hold them
+	ResourceManager::ReserveTextures();
+	Jobs = new JobSystem();
+	Loader = new AssetLoader(*Jobs);
+	for (unsigned int i = 0; i < TEXTURE_COUNT; ++i)
+		Loader->QueueTexture(static_cast<TextureID>(i));
+	Loader->Start();
 
 	glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(this->Width), static_cast<float>(this->Height),
 		0.0f, -1.0f, 1.0f);
-	ResourceManager::GetShader("sprite").Use().SetInteger("image", 0);
-	ResourceManager::GetShader("sprite").Use().SetMatrix4("projection", projection);
-	ResourceManager::GetShader("particle").Use().SetInteger("sprite", 0);
-	ResourceManager::GetShader("particle").Use().SetMatrix4("projection", projection);
-	//load textures
-	ResourceManager::LoadTexture("textures/background.jpg", false, "background");
-	ResourceManager::LoadTexture("textures/awesomeface.png", true, "face");
-	ResourceManager::LoadTexture("textures/block.png", true, "block");
-	ResourceManager::LoadTexture("textures/block_solid.png", true, "block_solid");
-	ResourceManager::LoadTexture("textures/paddle.png", true, "paddle");
-	ResourceManager::LoadTexture("textures/particle.png", true, "particle");
-	ResourceManager::LoadTexture("textures/powerup_speed.png", true, "powerup_speed");
-	ResourceManager::LoadTexture("textures/powerup_sticky.png", true, "powerup_sticky");
-	ResourceManager::LoadTexture("textures/powerup_increase.png", true, "powerup_increase");
-	ResourceManager::LoadTexture("textures/powerup_confuse.png", true, "powerup_confuse");
-	ResourceManager::LoadTexture("textures/powerup_chaos.png", true, "powerup_chaos");
-	ResourceManager::LoadTexture("textures/powerup_passthrough.png", true, "powerup_passthrough");
+	Globals = new GlobalsBuffer(projection, glm::vec2(this->Width, this->Height)); // read by every shader
+	ResourceManager::GetShader(SHADER_SPRITE).Use().SetInteger("image", 0);
+	ResourceManager::GetShader(SHADER_PARTICLE).Use().SetInteger("sprite", 0);
+	ResourceManager::GetShader(SHADER_BRICK).Use().SetInteger("block", 0);
+	ResourceManager::GetShader(SHADER_BRICK).SetInteger("blockSolid", 1);
 
 	// set render-specific controls
-	Renderer = new SpriteRenderer(ResourceManager::GetShader("sprite"));
-	Particles = new ParticleGenerator(ResourceManager::GetShader("particle"), ResourceManager::GetTexture("particle"), 800);
-	Effects = new PostProcessor(ResourceManager::GetShader("postprocessing"), this->Width, this->Height);
-	Text = new TextRenderer(this->Width, this->Height);
+	Stream = new StreamBuffer();
+	Queue = new RenderQueue();
+	Renderer = new SpriteRenderer(ResourceManager::GetShader(SHADER_SPRITE), *Stream, *Jobs);
+	Particles = new ParticleGenerator(ResourceManager::GetShader(SHADER_PARTICLE), ResourceManager::GetTexture(TEXTURE_PARTICLE), 800, *Stream, *Jobs);
+	Effects = new PostProcessor(ResourceManager::GetShader(SHADER_POSTPROCESSING), this->Width, this->Height, this->AntiAliasingMode);
+	Effects->SetRenderScale(this->RenderScale);
+	Resolution = new ResolutionController(this->TargetFps);
+	Resolution->Scale = Effects->GetRenderScale();
+	Blocks = new BrickRenderer(ResourceManager::GetShader(SHADER_BRICK), ResourceManager::GetTexture(TEXTURE_BLOCK),
+		ResourceManager::GetTexture(TEXTURE_BLOCK_SOLID), *Jobs);
+	Static = new StaticLayer(this->Width, this->Height);
+	Text = new TextRenderer(*Stream, *Queue);
 	Text->Load("fonts/ocratext.TTF", 24);
-	// load levels
-	GameLevel one;
-	GameLevel two;
-	GameLevel three;
-	GameLevel four;
-	one.Load("levels/one.txt", this->Width, this->Height / 2);
-	two.Load("levels/two.txt", this->Width, this->Height / 2);
-	three.Load("levels/three.txt", this->Width, this->Height / 2);
-	four.Load("levels/four.txt", this->Width, this->Height / 2);
-	this->Levels.push_back(one);
-	this->Levels.push_back(two);
-	this->Levels.push_back(three);
-	this->Levels.push_back(four);
-	this->Level = 0;
-	// configure game objects
-	glm::vec2 playerPos = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
-	Player = new GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTexture("paddle"));
-	glm::vec2 ballPos = playerPos + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -BALL_RADIUS * 2.0f);
-	Ball = new BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY, ResourceManager::GetTexture("face"));
+	// the world holds the texture names reserved above, they are filled in once loaded
+	this->World = new GameWorld(this->Width, this->Height, GameWorld::LoadLayouts(this->Width, this->Height),
+		static_cast<unsigned int>(std::chrono::steady_clock::now().time_since_epoch().count()), *Jobs);
 	//audio
-	SoundEngine->play2D("audio/breakout.mp3", true);
+	Speaker = CreateAudioDevice(this->AudioMode, this->AudioFile);
+	if (!Speaker)
+	{
+		std::cout << "ERROR::GAME: The " << AudioBackendName(this->AudioMode) << " audio device is not available, the game stays silent"
+			<< std::endl;
+		Speaker = new NullAudioDevice();
+	}
+	Audio = new SoundBank(*Speaker);
+	Audio->Load(); // a sound that failed to load only stays silent
+	Audio->Play(AUDIO_MUSIC, true);
+	this->loading = true;
+	return true;
+}
 
+void Game::KeyEvent(int key, bool pressed)
+{
+	if (key < 0 || key >= 1024)
+		return;
+	InputEvent event = { key, pressed, NowMs() };
+	if (!this->input.Push(event))
+		++this->droppedInputs;
 }
 
 void Game::ProcessInput(float dt)
 {
-	if (this->State == GAME_MENU)
+	// replay the key events received since the last step, timing how long the paddle keys were held
+	double end = NowMs();
+	double time = this->inputTime > 0.0 ? this->inputTime : end - dt * 1000.0;
+	double leftMs = 0.0, rightMs = 0.0;
+	std::fill(std::begin(this->keysPressed), std::end(this->keysPressed), false);
+	InputEvent event;
+	if (this->Autoplay && !this->loading)
 	{
-
-		if (this->Keys[GLFW_KEY_ENTER] && !this->KeysProcessed[GLFW_KEY_ENTER])
+		// the autoplayer works the keys like a player would, right at the start of the step
+		InputEvent botEvents[3];
+		unsigned int count = this->autoplay(time, dt, botEvents);
+		for (unsigned int i = 0; i < count; ++i)
+			this->replay(botEvents[i], time, end, leftMs, rightMs);
+	}
+	while (this->input.Pop(event))
+		this->replay(event, time, end, leftMs, rightMs);
+	if (this->Keys[GLFW_KEY_A])
+		leftMs += end - time;
+	if (this->Keys[GLFW_KEY_D])
+		rightMs += end - time;
+	this->inputTime = end;
+
+	if (this->keyDown(GLFW_KEY_M) && !this->KeysProcessed[GLFW_KEY_M] && !this->loading)
+	{
+		this->SetAntiAliasing(static_cast<AntiAliasing>((this->AntiAliasingMode + 1) % AA_MODE_COUNT));
+		this->KeysProcessed[GLFW_KEY_M] = true;
+	}
+	if (this->loading)
+		return;
+	// translate the keys into what the world understands; it only applies what fits its state
+	WorldInput& step = this->pending;
+	step.Left = static_cast<float>(leftMs / 1000.0);
+	step.Right = static_cast<float>(rightMs / 1000.0);
+	step.Launch = this->keyDown(GLFW_KEY_SPACE);
+	if (this->World->State == GAME_MENU)
+	{
+		if (this->keyDown(GLFW_KEY_ENTER) && !this->KeysProcessed[GLFW_KEY_ENTER])
 		{
-			this->State = GAME_ACTIVE;
+			step.Confirm = true;
 			this->KeysProcessed[GLFW_KEY_ENTER] = true;
 		}
-
-		if (this->Keys[GLFW_KEY_W] && !this->KeysProcessed[GLFW_KEY_W]) {
-			this->Level = (this->Level + 1) % 4;
+		if (this->keyDown(GLFW_KEY_W) && !this->KeysProcessed[GLFW_KEY_W])
+		{
+			++step.LevelStep;
 			this->KeysProcessed[GLFW_KEY_W] = true;
 		}
-
-		if (this->Keys[GLFW_KEY_S] && !this->KeysProcessed[GLFW_KEY_S])
+		if (this->keyDown(GLFW_KEY_S) && !this->KeysProcessed[GLFW_KEY_S])
 		{
-			if (this->Level > 0)
-				--this->Level;
-			else
-				this->Level = 3;
+			--step.LevelStep;
 			this->KeysProcessed[GLFW_KEY_S] = true;
 		}
 	}
-	if (this->State == GAME_WIN)
+	if (this->World->State == GAME_WIN)
 	{
-		if (this->Keys[GLFW_KEY_ENTER])
+		if (this->keyDown(GLFW_KEY_ENTER))
 		{
+			step.Confirm = true;
 			this->KeysProcessed[GLFW_KEY_ENTER] = true;
-			Effects->Chaos = false;
-			this->State = GAME_MENU;
-		}
-	}
-	if (this->State == GAME_ACTIVE) {
-		float velocity = PLAYER_VELOCITY * dt;
-		//move
-		if (this->Keys[GLFW_KEY_A])
-		{
-			if (Player->Position.x >= 0.0f) {
-				Player->Position.x -= velocity;
-				if (Ball->Stuck)
-					Ball->Position.x -= velocity;
-			}
 		}
-		if (this->Keys[GLFW_KEY_D])
-		{
-			if (Player->Position.x <= this->Width - Player->Size.x) {
-				Player->Position.x += velocity;
-				if (Ball->Stuck)
-					Ball->Position.x += velocity;
-			}
-		}
-		if (this->Keys[GLFW_KEY_SPACE])
-			Ball->Stuck = false;
 	}
 }
 
 
-void Game::Update(float dt)
+void Game::replay(const InputEvent& event, double& time, double end, double& leftMs, double& rightMs)
 {
-	Ball->Move(dt, this->Width); // update objects
-	this->DoCollisions(); // check for collisions
-
-	Particles->Update(dt, *Ball, 2, glm::vec2(Ball->Radius / 2.0f)); // update particles
-
-	this->UpdatePowerUps(dt); // update power ups
-
-	if (ShakeTime > 0.0f)
-	{
-		ShakeTime -= dt;
-		if (ShakeTime <= 0.0f)
-			Effects->Shake = false;
-	}
-	// check loss condition
-	if (Ball->Position.y >= this->Height) // did ball reach bottom edge?
-	{
-		--this->Lives;
-		if (this->Lives <= 0) { // did the player lose all his lives? : Game over
-			this->ResetLevel();
-			this->State = GAME_MENU;
-		}
-		this->ResetPlayer();
-	}
-	// check win condition
-	if (this->State == GAME_ACTIVE && this->Levels[this->Level].IsCompleted()) 
+	// an event that arrived while this step was starting counts as happening at its end
+	double at = std::min(std::max(event.Time, time), end);
+	if (this->Keys[GLFW_KEY_A])
+		leftMs += at - time;
+	if (this->Keys[GLFW_KEY_D])
+		rightMs += at - time;
+	time = at;
+	this->Keys[event.Key] = event.Pressed;
+	if (event.Pressed)
 	{
-		this->ResetLevel();
-		this->ResetPlayer();
-		Effects->Chaos = true;
-		this->State = GAME_WIN;
+		this->keysPressed[event.Key] = true;
+		this->KeysProcessed[event.Key] = false; // a new press can be acted on again
 	}
-
 }
 
-void Game::Render()
+unsigned int Game::autoplay(double time, float dt, InputEvent* events)
 {
-	if (this->State == GAME_ACTIVE || this->State == GAME_MENU)
-	{
-		Effects->BeginRender();
-		//draw background
-		Renderer->DrawSprite(ResourceManager::GetTexture("background"),
-			glm::vec2(0.0f, 0.0f), glm::vec2(this->Width, this->Height), 0.0f);
-		//draw level
-		this->Levels[this->Level].Draw(*Renderer);
-
-		Player->Draw(*Renderer);	 //draw player
-		for (PowerUp& powerUp : this->PowerUps)
-			if (!powerUp.Destroyed)
-				powerUp.Draw(*Renderer); //draw powerups
-		Particles->Draw();  //draw particles
-		Ball->Draw(*Renderer);	     //draw ball
-		Effects->EndRender();
-		Effects->Render((float)glfwGetTime());
-
-		std::stringstream ss; ss << this->Lives;
-		Text->RenderText("Lives:" + ss.str(), 5.0f, 5.0f, 1.0f);
-	}
-	if (this->State == GAME_MENU)
+	// hold A or D for a whole step only when the paddle is at least half a step away from where it should be
+	static const int keys[3] = { GLFW_KEY_A, GLFW_KEY_D, GLFW_KEY_SPACE };
+	BatchAction action = this->autoplayer.Decide(*this->World, dt);
+	bool held[3] = { action.Move <= -0.5f, action.Move >= 0.5f, action.Launch != 0 };
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < 3; ++i)
 	{
-		Text->RenderText("Press ENTER to start", 250.0f, Height / 2, 1.0f);
-		Text->RenderText("Press W or S to select level", 245.0f, Height / 2 + 20.0f, 0.75f);
+		if (this->Keys[keys[i]] == held[i])
+			continue;
+		InputEvent event = { keys[i], held[i], time };
+		events[count++] = event;
 	}
+	return count;
+}
 
-	if (this->State == GAME_WIN)
+void Game::Update(float dt)
+{
+	if (this->loading)
 	{
-		Text->RenderText("You WON!!!", 320.0, Height / 2 - 20.0, 1.0, glm::vec3(0.0, 1.0, 0.0));
-		Text->RenderText("Press ENTER to retry or ESC to quit", 130.0, Height / 2, 1.0, glm::vec3(1.0, 1.0, 0.0));
+		if (Loader->Upload(TEXTURE_UPLOAD_BUDGET_MS))
+		{
+			Loader->PrintReport();
+			if (Loader->Failed())
+			{
+				std::cout << "ERROR::GAME: Failed to load textures" << std::endl;
+				glfwSetWindowShouldClose(glfwGetCurrentContext(), true);
+			}
+			delete Loader;
+			Loader = nullptr;
+			this->loading = false;
+		}
+		this->publish();
+		return;
 	}
+	this->World->Step(this->pending, dt);
+	this->pending = WorldInput();
+	this->spawnDebris();
+	Particles->Update(dt, this->World->Ball, 2, glm::vec2(this->World->Ball.Radius / 2.0f)); // update particles
+	this->playSounds();
+	this->publish();
 }
 
-void Game::ResetLevel()
+void Game::playSounds()
 {
-	if (this->Level == 0)
-		this->Levels[0].Load("levels/one.txt", this->Width, this->Height / 2);
-	else if (this->Level == 1)
-		this->Levels[1].Load("levels/two.txt", this->Width, this->Height / 2);
-	else if (this->Level == 2)
-		this->Levels[2].Load("levels/three.txt", this->Width, this->Height / 2);
-	else if (this->Level == 3)
-		this->Levels[3].Load("levels/four.txt", this->Width, this->Height / 2);
-	this->Lives = 3;
+	// indexed by GameEventType
+	static const AudioID eventSounds[GAME_EVENT_TYPE_COUNT] = { AUDIO_BRICK, AUDIO_SOLID, AUDIO_PADDLE, AUDIO_POWERUP };
+	for (const GameEvent& event : this->World->Events)
+		Audio->Play(eventSounds[event.Type]);
 }
 
-//resets player//ball stats
-void Game::ResetPlayer()
+void Game::spawnDebris()
 {
-	Player->Size = PLAYER_SIZE;
-	Player->Position = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
-	Ball->Reset(Player->Position + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -(BALL_RADIUS * 2.0f)), INITIAL_BALL_VELOCITY);
+	for (const GameEvent& event : this->World->Events)
+		if (event.Type == EVENT_BRICK_DESTROYED)
+			Particles->Burst(event.Position, DEBRIS_PARTICLES);
 }
 
-bool CheckCollision(GameObject& one, GameObject& two)
+static SpriteState spriteOf(const GameObject& object, RenderLayer layer)
 {
-	bool collisionX = one.Position.x + one.Size.x >= two.Position.x &&
-		two.Position.x + two.Size.x >= one.Position.x; // collision x-axis?
-	bool collisionY = one.Position.y + one.Size.y >= two.Position.y &&
-		two.Position.y + two.Size.y >= one.Position.y; // collision y-axis?
-	//collision only if on both axes
-	return collisionX && collisionY;
+	SpriteState sprite = { object.Sprite, object.Position, object.Size, object.Color, object.Rotation, layer };
+	return sprite;
 }
 
-// calculates with direction a vector is facing (N,E,S or W)
-Direction VectorDirection(glm::vec2 target)
+void Game::publish()
 {
-	glm::vec2 compass[] = {
-		glm::vec2(0.0f, 1.0f),  // up
-		glm::vec2(1.0f, 0.0f),	// right
-		glm::vec2(0.0f, -1.0f), //down
-		glm::vec2(-1.0f, 0.0f)  //left
-	};
-	float max = 0.0f;
-	unsigned int best_match = -1;
-	for (unsigned int i = 0; i < 4; i++)
+	GameSnapshot& snapshot = this->snapshots.WriteBuffer();
+	const GameWorld& world = *this->World;
+	snapshot.State = this->loading ? GAME_LOADING : world.State;
+	snapshot.Lives = world.Lives;
+	snapshot.LastClear = world.LastClear;
+	snapshot.AntiAliasingMode = this->AntiAliasingMode;
+	snapshot.Screen = world.Screen;
+	if (!this->loading)
 	{
-		float dot_product = glm::dot(glm::normalize(target), compass[i]);
-		if (dot_product > max)
-		{
-			max = dot_product;
-			best_match = i;
-		}
+		snapshot.Sprites.clear();
+		snapshot.Sprites.push_back(spriteOf(world.Player, LAYER_PLAYER));
+		for (const PowerUp& powerUp : world.PowerUps)
+			if (!powerUp.Destroyed)
+				snapshot.Sprites.push_back(spriteOf(powerUp, LAYER_POWERUPS));
+		snapshot.Sprites.push_back(spriteOf(world.Ball, LAYER_BALL));
+		Particles->Snapshot(snapshot.Particles);
+		// the buffer is reused, so the bricks only need copying when this buffer's copy is stale
+		const GameLevel& level = world.Levels[world.Level];
+		if (snapshot.Level.Generation != level.Generation || snapshot.Level.Revision != level.Revision)
+			snapshot.Level = level;
 	}
-	return (Direction)best_match;
+	this->snapshots.Publish();
 }
 
-Collision CheckCollision(BallObject& one, GameObject& two)
+void Game::StartSimulation()
 {
-	glm::vec2 center(one.Position + one.Radius); // get center point circle first
-	//calculate AABB info (center, half-extents)
-	glm::vec2 aabb_half_extents(two.Size.x / 2.0f, two.Size.y / 2.0f);
-	glm::vec2 aabb_center(
-		two.Position.x + aabb_half_extents.x,
-		two.Position.y + aabb_half_extents.y
-	);
-	glm::vec2 difference = center - aabb_center; // get difference vector between both centers
-	glm::vec2 clamped = glm::clamp(difference, -aabb_half_extents, aabb_half_extents);
-	glm::vec2 closest = aabb_center + clamped;//add a clamped value to AABB_center and we get the value of box closest to the circle
-	difference = closest - center; // retrieve vector between center circle and closest point AABB and check if length <= radius
+	if (this->simulating)
+		return;
+	// uploading textures needs the GL context, which stays on the thread that called Init()
+	if (this->loading)
+	{
+		std::cout << "ERROR::GAME: The simulation cannot start before the loading screen is finished" << std::endl;
+		return;
+	}
+	this->simulating = true;
+	this->simulation = std::thread(&Game::simulate, this);
+}
 
-	if (glm::length(difference) <= one.Radius)
-		return std::make_tuple(true, VectorDirection(difference), difference);
-	else
-		return std::make_tuple(false, UP, glm::vec2(0.0f, 0.0f));
+void Game::StopSimulation()
+{
+	if (!this->simulating)
+		return;
+	this->simulating = false;
+	this->simulation.join();
 }
 
-void ActivatePowerUp(PowerUp& powerUp)
+void Game::simulate()
 {
-	if (powerUp.Type == "speed")
-	{
-		Ball->Velocity *= 1.2;
-	}
-	else if (powerUp.Type == "sticky")
-	{
-		Ball->Sticky = true;
-		Player->Color = glm::vec3(1.0f, 0.5f, 1.0f);
-	}
-	else if (powerUp.Type == "pass-through")
-	{
-		Ball->PassThrough = true;
-		Ball->Color = glm::vec3(1.0f, 0.5f, 0.5f);
-	}
-	else if (powerUp.Type == "pad-size-increase")
+	// fixed steps, so gameplay doesn't depend on how fast frames are rendered
+	const double tickMs = 1000.0 / this->TickRate;
+	const float dt = static_cast<float>(tickMs / 1000.0);
+	double next = NowMs();
+	while (this->simulating)
 	{
-		Player->Size.x += 50;
-	}
-	else if (powerUp.Type == "confuse")
-	{
-		if (!Effects->Chaos)
-			Effects->Confuse = true; // only activate if chaos wasn't  already active
-	}
-	else if (powerUp.Type == "chaos")
-	{
-		if (!Effects->Confuse)
-			Effects->Chaos = true;
-			/*SoundEngine->stopAllSounds();
-			SoundEngine->play2D("audio/Sonic-Chaos.mp3", true);*/
+		double start = NowMs();
+		this->ProcessInput(dt);
+		this->Update(dt);
+		double end = NowMs();
+		this->SimTimes.Add(end - start);
+		next += tickMs;
+		if (end < next)
+			std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(next - end));
+		else if (end - next > MAX_SIMULATION_LAG_MS)
+			next = end;
 	}
 }
 
-void Game::DoCollisions()
+void Game::Render()
 {
-	for (GameObject& box : this->Levels[this->Level].Bricks)
+	double start = NowMs();
+	const GameSnapshot& frame = this->snapshots.Read();
+	Globals->Values.Time = static_cast<float>(glfwGetTime());
+	int framebufferWidth, framebufferHeight;
+	glfwGetFramebufferSize(glfwGetCurrentContext(), &framebufferWidth, &framebufferHeight); // follows resizes
+	Globals->Values.Viewport = glm::vec2(framebufferWidth, framebufferHeight);
+	Globals->Values.RenderScale = Effects->GetRenderScale();
+	Globals->Upload();
+	Stream->BeginFrame();
+	if (frame.State == GAME_LOADING)
+	{
+		std::stringstream ss; ss << "Loading " << static_cast<int>(Loader->Progress() * 100.0f) << "%";
+		Text->RenderText(ss.str(), 320.0f, Height / 2, 1.0f);
+		Queue->Flush();
+		Stream->EndFrame();
+		this->RenderTimes.Add(NowMs() - start);
+		return;
+	}
+	if (Effects->GetAntiAliasing() != frame.AntiAliasingMode)
+		Effects->SetAntiAliasing(frame.AntiAliasingMode);
+	Effects->Chaos = frame.Screen.Chaos;
+	Effects->Confuse = frame.Screen.Confuse;
+	Effects->Shake = frame.Screen.Shake;
+	if (frame.State == GAME_ACTIVE || frame.State == GAME_MENU)
 	{
-		if (!box.Destroyed)
+		Effects->BeginRender();
+		//queue background and level, cached until a brick is destroyed
+		Static->Draw(*Queue, *Renderer, *Blocks, ResourceManager::GetTexture(TEXTURE_BACKGROUND), frame.Level);
+
+		// prepare the frame's vertex and instance data in parallel, then queue the draws
+		Renderer->PushSprites(*Queue, frame.Sprites); //player, powerups and ball
+		Particles->Draw(*Queue, frame.Particles);	  //particles
+		Queue->Flush(); // the scene is drawn here, in layer order
+		Effects->EndRender();
+		Effects->Render();
+		if (Resolution->Update(Effects->FrameTimer(frame.AntiAliasingMode)))
 		{
-			Collision collision = CheckCollision(*Ball, box);
-			if (std::get<0>(collision)) // if collision is true
-			{
-				if (!box.IsSolid) { // destroy block if not solid
-					box.Destroyed = true;
-					this->SpawnPowerUps(box);
-					SoundEngine->play2D("audio/bleep.mp3", false);
-				}
-				else {
-					//if block is solid, enable shake effect
-					ShakeTime = 0.05f;
-					Effects->Shake = true;
-					SoundEngine->play2D("audio/solid.wav", false);
-				}
-				//collision resolution
-				Direction dir = std::get<1>(collision);
-				glm::vec2 diff_vector = std::get<2>(collision);
-				if (!(Ball->PassThrough && !box.IsSolid)) { // dont do collision resolution on non-solid bricks if pass-through is activated
-					if (dir == LEFT || dir == RIGHT) // horizontal collision
-					{
-						Ball->Velocity.x = -Ball->Velocity.x; // reverse horizontal velocity
-						//relocate
-						float penetration = Ball->Radius - std::abs(diff_vector.x);
-						if (dir == LEFT)
-							Ball->Position.x += penetration; // move ball to right
-						else
-							Ball->Position.x -= penetration; // move ball to left
-					}
-					else // vertical collision
-					{
-						Ball->Velocity.y = -Ball->Velocity.y; // reverse vertical velocity
-						float penetration = Ball->Radius - std::abs(diff_vector.y);
-						if (dir == UP)
-							Ball->Position.y -= penetration; // move ball back up
-						else
-							Ball->Position.y += penetration; // move ball back down
-					}
-				}
-			}
-		}
-		// also check collisions on Powerups and if so, activate them
-		for (PowerUp& powerUp : this->PowerUps) {
-			if (!powerUp.Destroyed)
-			{
-				if (powerUp.Position.y >= this->Height) //first check if powerup passed bottom edge, if so: keep as inactive and destroyed
-					powerUp.Destroyed = true;
-				if (CheckCollision(*Player, powerUp)) {
-					//collided with player, now activate powerup
-					ActivatePowerUp(powerUp);
-					powerUp.Destroyed = true;
-					powerUp.Activated = true;
-					SoundEngine->play2D("audio/powerup.wav", false);
-				}
-			}
+			Effects->SetRenderScale(Resolution->Scale);
+			this->RenderScale = Effects->GetRenderScale();
 		}
+
+		std::stringstream ss; ss << frame.Lives;
+		Text->RenderText("Lives:" + ss.str(), 5.0f, 5.0f, 1.0f);
 	}
-	Collision result = CheckCollision(*Ball, *Player); // and finally check collisions for player pad(unsless stuck)
-	if (!Ball->Stuck && std::get<0>(result))
+	if (frame.State == GAME_MENU)
 	{
-		float centerBoard = Player->Position.x + Player->Size.x / 2.0f; // check where it hit the board, and change velocity based on where it hit the board
-		float distance = (Ball->Position.x + Ball->Radius) - centerBoard;
-		float percentage = distance / (Player->Size.x / 2.0f);
-		// then move accordingly
-		float strength = 2.0f;
-		glm::vec2 oldVelocity = Ball->Velocity;
-		Ball->Velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
-		//Ball->Velocity.y = Ball->Velocity.y;
-		Ball->Velocity.y = -1.0f * abs(Ball->Velocity.y);
-		Ball->Velocity = glm::normalize(Ball->Velocity) * glm::length(oldVelocity);
-		Ball->Stuck = Ball->Sticky;
-
-		SoundEngine->play2D("audio/bleep.wav", false);
+		Text->RenderText("Press ENTER to start", 250.0f, Height / 2, 1.0f);
+		Text->RenderText("Press W or S to select level", 245.0f, Height / 2 + 20.0f, 0.75f);
 	}
 
+	if (frame.State == GAME_WIN)
+	{
+		Text->RenderText("You WON!!!", 320.0, Height / 2 - 20.0, 1.0, glm::vec3(0.0, 1.0, 0.0));
+		Text->RenderText("Press ENTER to retry or ESC to quit", 130.0, Height / 2, 1.0, glm::vec3(1.0, 1.0, 0.0));
+		std::stringstream ss; ss.precision(1);
+		ss << std::fixed << frame.LastClear.BricksDestroyed << " bricks in " << frame.LastClear.ClearTime << "s";
+		Text->RenderText(ss.str(), 280.0, Height / 2 + 20.0, 0.75, glm::vec3(1.0, 1.0, 0.0));
+	}
+	Queue->Flush(); // text overlay, after post-processing
+	Stream->EndFrame();
+	this->RenderTimes.Add(NowMs() - start);
 }
 
-bool ShouldSpawn(unsigned int chance)
+void Game::SetAntiAliasing(AntiAliasing mode)
 {
-	unsigned int random = rand() % chance;
-	return random == 0;
+	this->AntiAliasingMode = mode; // applied by the next Render()
+	std::cout << "GAME: anti-aliasing " << AntiAliasingName(mode) << std::endl;
 }
-void Game::SpawnPowerUps(GameObject& block)
-{
-	if (ShouldSpawn(75)) // 1 in 75 chance
-		this->PowerUps.push_back(PowerUp("speed", glm::vec3(0.5f, 0.5f, 1.0f), 0.0f, block.Position, ResourceManager::GetTexture("powerup_speed")));
-	if (ShouldSpawn(75))
-		this->PowerUps.push_back(PowerUp("sticky", glm::vec3(1.0f, 0.5f, 1.0f), 20.0f, block.Position, ResourceManager::GetTexture("powerup_sticky")));
-	if (ShouldSpawn(75))
-		this->PowerUps.push_back(PowerUp("pass-through", glm::vec3(0.5f, 1.0f, 0.5f), 10.0f, block.Position, ResourceManager::GetTexture("powerup__passthrough")));
-	if (ShouldSpawn(75))
-		this->PowerUps.push_back(PowerUp("pad-size-increase", glm::vec3(1.0f, 0.6f, 0.4f), 0.0f, block.Position, ResourceManager::GetTexture("powerup_increase")));
-	if (ShouldSpawn(15)) // negative powerups should spawn more often
-		this->PowerUps.push_back(PowerUp("confuse", glm::vec3(1.0f, 0.3f, 0.3f), 15.0f, block.Position, ResourceManager::GetTexture("powerup_confuse")));
-	if (ShouldSpawn(15))
-		this->PowerUps.push_back(PowerUp("chaos", glm::vec3(0.9f, 0.25f, 0.25f), 15.0f, block.Position, ResourceManager::GetTexture("powerup_chaous")));
-}
-
 
-
-bool IsOtherPowerUpActive(std::vector<PowerUp>& powerUps, std::string type)
+void Game::SetRenderScale(float scale)
 {
-	for (const PowerUp& powerUp : powerUps)
-	{
-		if (powerUp.Activated)
-			if (powerUp.Type == type)
-				return true;
-	}
-	return false;
+	Resolution->TargetMs = 0.0f;
+	Effects->SetRenderScale(scale);
+	this->RenderScale = Resolution->Scale = Effects->GetRenderScale();
 }
 
-void Game::UpdatePowerUps(float dt) {
-
-	for (PowerUp& powerUp : this->PowerUps)
-	{
-		powerUp.Position += powerUp.Velocity * dt;
-		if (powerUp.Activated)
-		{
-			powerUp.Duration -= dt;
-
-			if (powerUp.Duration <= 0.0f)
-			{
-				// remove powerup from list (will later be removed)
-				powerUp.Activated = false;
-				//deactivate effects
-				if (powerUp.Type == "sticky")
-				{
-					if (!IsOtherPowerUpActive(this->PowerUps, "sticky")) {
-						//only reset if no other powerup of type sticky is active
-						Ball->Sticky = false;
-						Player->Color = glm::vec3(1.0f);
-					}
-				}
-				else if (powerUp.Type == "pass-through")
-				{
-					if (!IsOtherPowerUpActive(this->PowerUps, "pass-through"))
-					{
-						//only reset if no other PowerUp of type pass-through is active
-						Ball->PassThrough = false;
-						Ball->Color = glm::vec3(1.0f);
-					}
-				}
-				else if (powerUp.Type == "confuse")
-				{
-					if (!IsOtherPowerUpActive(this->PowerUps, "confuse"))
-					{
-						//only rest if no other Powerup of type confuse is active
-						Effects->Confuse = false;
-					}
-				}
-				else if (powerUp.Type == "chaos")
-				{
-					if (!IsOtherPowerUpActive(this->PowerUps, "chaos"))
-					{
-						//only reset if no other powerup of type chaos is active
-						Effects->Chaos = false;
-					}
-				}
-			}
-		}
-	}
-	// Remove all PowerUps from vector that are destroyed AND !activated (thus either off the map or finished)
-   // Note we use a lambda expression to remove each PowerUp which is destroyed and not activated
-	this->PowerUps.erase(std::remove_if(this->PowerUps.begin(), this->PowerUps.end(),
-		[](const PowerUp& powerUp) { return powerUp.Destroyed && !powerUp.Activated; }
-	), this->PowerUps.end());
+const GpuTimer& Game::FrameTimer(AntiAliasing mode) const
+{
+	return Effects->FrameTimer(mode);
 }
-
@@ -1,52 +1,97 @@
 #ifndef  GAME_H
 #define  GAME_H
+#include <atomic>
+#include <thread>
 #include <vector>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
-#include "game_level.h"
-#include "power_up.h"
+#include "game_world.h"
+#include "autoplayer.h"
+#include "audio_device.h"
+#include "postprocessor.h"
+#include "particle_generator.h"
+#include "triple_buffer.h"
+#include "spsc_ring.h"
+#include "timer.h"
 
-enum GameState {
-	GAME_ACTIVE,
-	GAME_MENU,
-	GAME_WIN
-};
+const float SIM_TICK_RATE(120.0f);			//simulation steps per second when it runs on its own thread
+const unsigned int INPUT_QUEUE_SIZE = 256;	//key events that can wait for the next simulation step
+const unsigned int DEBRIS_PARTICLES = 6;	//particles bursting from every destroyed brick
 
-enum Direction {
-	UP,
-	RIGHT,
-	DOWN,
-	LEFT
+// a key going down or up, as reported by GLFW
+struct InputEvent {
+	int	   Key;
+	bool   Pressed;
+	double Time; // NowMs() when the event was received
 };
 
+// The state of the game after one simulation step. The simulation
+// publishes one per step, and the renderer draws only from the latest.
+struct GameSnapshot {
+	GameState	 State;
+	unsigned int Lives;
+	LevelStats	 LastClear;
+	AntiAliasing AntiAliasingMode;
+	EffectFlags	 Screen;
+	std::vector<SpriteState> Sprites;	// paddle, falling power-ups and ball
+	std::vector<Particle>	 Particles; // live particles
+	GameLevel	 Level;					// copied only when its bricks changed since this buffer was last written
 
-const glm::vec2 PLAYER_SIZE(100.0f, 20.0f); //initial size of the player
-const float PLAYER_VELOCITY(500.0f);		//initial player velocity
+	GameSnapshot() : State(GAME_LOADING), Lives(0), AntiAliasingMode(AA_OFF) { }
+};
 
 
 class Game {
 public:	
-	GameState			   State;
-	bool				   Keys[1024];
-	bool				   KeysProcessed[1024];
-	std::vector<GameLevel> Levels;
-	std::vector<PowerUp>   PowerUps;
-	unsigned int		   Level;
+	GameWorld*			   World;				// the game being played, created by Init()
+	bool				   Keys[1024];			// held keys and keys whose press was already acted on, as of the
+	bool				   KeysProcessed[1024];	// last simulation step; only ProcessInput writes them
 	unsigned int		   Width, Height;
-	unsigned int		   Lives;
+	AntiAliasing		   AntiAliasingMode; // may be set before Init(); cycled with M while playing
+	float				   RenderScale;		 // fraction of the window size the scene is rendered at
+	float				   TargetFps;		 // dynamic resolution holds the scene to this frame rate, 0 keeps RenderScale fixed
+	float				   TickRate;		 // simulation steps per second once StartSimulation() is called
+	bool				   Autoplay;		 // an AutoPlayer works the paddle keys alongside the player
+	AudioBackend		   AudioMode;		 // the device sounds play on; set before Init()
+	const char*			   AudioFile;		 // the software mixer also writes what it plays here, if set
+	TimingStats			   SimTimes, RenderTimes; // CPU time per simulation step and per rendered frame
 	Game(unsigned int width, unsigned int height);
 	~Game();
-	void Init();
+	bool Init(); // returns false if the game could not be set up
+	// ProcessInput and Update advance the simulation and publish a snapshot of it; Render draws the latest
+	// snapshot and must be called on the GL context thread. Until StartSimulation() all three are called
+	// from the same thread; afterwards the simulation thread alone calls the first two.
 	void ProcessInput(float dt);
 	void Update(float dt);
 	void Render();
-	void DoCollisions();
-	void ResetLevel();
-	void ResetPlayer();
-	//powerups
-	void SpawnPowerUps(GameObject& block);
-	void UpdatePowerUps(float dt);
+	void KeyEvent(int key, bool pressed); // queues a key event for the next step; call from one thread only
+	void StartSimulation(); // steps the game at TickRate on its own thread; does nothing while Loading()
+	void StopSimulation();
+	bool Loading() const { return this->loading; } // textures are still being uploaded behind the loading screen
+	void SetAntiAliasing(AntiAliasing mode);
+	void SetRenderScale(float scale); // fixes the render scale, turning dynamic resolution off
+	const GpuTimer& FrameTimer(AntiAliasing mode) const; // GPU time of the scene in a mode
+private:
+	SpscRing<InputEvent, INPUT_QUEUE_SIZE> input;
+	bool					   keysPressed[1024]; // went down during the current step, even if already released again
+	double					   inputTime;		  // when the events of the last step ended
+	unsigned int			   droppedInputs;	  // events lost to a full queue, written by the KeyEvent thread
+	WorldInput				   pending;			  // what ProcessInput gathered for the next Update
+	AutoPlayer				   autoplayer;
+	bool					   loading;
+	TripleBuffer<GameSnapshot> snapshots;
+	std::thread				   simulation;
+	std::atomic<bool>		   simulating;
+	bool keyDown(int key) const { return this->Keys[key] || this->keysPressed[key]; } // at any point during the step
+	// applies one key event at its time within the step [time, end], adding to how long A and D were held
+	void replay(const InputEvent& event, double& time, double end, double& leftMs, double& rightMs);
+	unsigned int autoplay(double time, float dt, InputEvent* events); // the autoplayer's key events, at most 3
+	// the presentation of the events of the world's last step, one pass each
+	void playSounds();
+	void spawnDebris();
+	void publish();
+	void simulate();
 };
 #endif
\ No newline at end of file
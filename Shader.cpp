@@ -2,30 +2,33 @@
 
 #include <iostream>
 
+#include "gl_extensions.h"
+
 Shader& Shader::Use()
 {
 	glUseProgram(this->ID);
 	return *this;
 }
 
-void Shader::Compile(const char* vertexSource, const char* fragmentSource, const char* geometrySource)
+bool Shader::Compile(const char* vertexSource, const char* fragmentSource, const char* geometrySource)
 {
 	unsigned int sVertex, sFragment, gShader;
+	bool success = true;
 	sVertex = glCreateShader(GL_VERTEX_SHADER);
 	glShaderSource(sVertex, 1, &vertexSource, NULL);
 	glCompileShader(sVertex);
-	checkCompileErrors(sVertex, "VERTEX");
+	success &= checkCompileErrors(sVertex, "VERTEX");
 
 	sFragment = glCreateShader(GL_FRAGMENT_SHADER);
 	glShaderSource(sFragment, 1, &fragmentSource, NULL);
 	glCompileShader(sFragment);
-	checkCompileErrors(sFragment, "FRAGMENT");
+	success &= checkCompileErrors(sFragment, "FRAGMENT");
 
 	if (geometrySource != nullptr) {
 		gShader = glCreateShader(GL_GEOMETRY_SHADER);
 		glShaderSource(gShader, 1, &geometrySource, NULL);
 		glCompileShader(gShader);
-		checkCompileErrors(gShader, "GEOMETRY");
+		success &= checkCompileErrors(gShader, "GEOMETRY");
 	}
 
 	this->ID = glCreateProgram();
@@ -33,14 +36,16 @@ void Shader::Compile(const char* vertexSource, const char* fragmentSource, const
 	glAttachShader(this->ID, sFragment);
 	if (geometrySource != nullptr)
 		glAttachShader(this->ID, gShader);
+	if (GLExtensions::ProgramBinary) // keep the linked binary around so it can be cached
+		GLExtensions::ProgramParameteri(this->ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	glLinkProgram(this->ID);
-	checkCompileErrors(this->ID, "PROGRAM");
+	success &= checkCompileErrors(this->ID, "PROGRAM");
 
 	glDeleteShader(sVertex);
 	glDeleteShader(sFragment);
 	if (geometrySource != nullptr)
 		glDeleteShader(gShader);
-
+	return success;
 }
 
 void Shader::SetFloat(const char* name, float value, bool useShader)
@@ -106,7 +111,14 @@ void Shader::SetMatrix4(const char* name, const glm::mat4& matrix, bool useShade
 	glUniformMatrix4fv(glGetUniformLocation(this->ID, name), 1, false, glm::value_ptr(matrix));
 }
 
-void Shader::checkCompileErrors(unsigned int object, std::string type)
+void Shader::BindUniformBlock(const char* name, unsigned int binding)
+{
+	unsigned int index = glGetUniformBlockIndex(this->ID, name);
+	if (index != GL_INVALID_INDEX)
+		glUniformBlockBinding(this->ID, index, binding);
+}
+
+bool Shader::checkCompileErrors(unsigned int object, std::string type)
 {
 	int success;
 	char infoLog[1024];
@@ -129,4 +141,5 @@ void Shader::checkCompileErrors(unsigned int object, std::string type)
 				<< std::endl;
 		}
 	}
+	return success != 0;
 }
@@ -0,0 +1,119 @@
+#include "asset_loader.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#include "resource_manager.h"
+#include "timer.h"
+
+AssetLoader::AssetLoader(JobSystem& jobs)
+	: jobs(jobs), uploaded(0), failed(false), startTime(0.0), finishTime(0.0)
+{
+}
+
+AssetLoader::~AssetLoader()
+{
+	this->jobs.Wait(this->decoding);
+}
+
+void AssetLoader::QueueTexture(TextureID id)
+{
+	Request request = { id, std::unique_ptr<TextureImage>(new TextureImage()), false, false, 0.0, 0.0, std::string() };
+	this->requests.push_back(std::move(request));
+}
+
+void AssetLoader::Start()
+{
+	this->startTime = NowMs();
+	this->ready.reserve(this->requests.size());
+	// one texture per job; nobody waits for them, so they run on the job system's workers
+	this->decoding = this->jobs.ScheduleParallelFor(static_cast<unsigned int>(this->requests.size()), 1,
+		[this](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int index = begin; index < end; ++index)
+			this->decode(index);
+	});
+}
+
+void AssetLoader::decode(unsigned int index)
+{
+	// the requests vector is not resized after Start, so jobs can write their own entry without locking
+	Request& request = this->requests[index];
+	const TextureAsset& asset = TextureManifest[request.Id];
+	double begin = NowMs();
+	if (asset.File != nullptr)
+		request.Loaded = TextureCache::Load(asset.File, asset.Alpha, asset.Mipmaps, *request.Image, request.CacheHit,
+			&request.Messages);
+	else
+		request.Messages = "ERROR::ASSET_LOADER: Texture " + std::to_string(request.Id) + " is missing from the asset manifest\n";
+	request.DecodeMs = NowMs() - begin;
+
+	std::lock_guard<std::mutex> lock(this->readyMutex);
+	this->ready.push_back(index);
+}
+
+bool AssetLoader::Upload(double budgetMs)
+{
+	double begin = NowMs();
+	while (this->uploaded < this->requests.size())
+	{
+		unsigned int index;
+		{
+			std::lock_guard<std::mutex> lock(this->readyMutex);
+			if (this->ready.empty())
+				break;
+			index = this->ready.back();
+			this->ready.pop_back();
+		}
+		Request& request = this->requests[index];
+		double uploadBegin = NowMs();
+		if (request.Loaded)
+		{
+			ResourceManager::UploadTexture(request.Id, *request.Image);
+			request.Image->Release();
+		}
+		else
+			this->failed = true;
+		request.UploadMs = NowMs() - uploadBegin;
+		++this->uploaded;
+		if (NowMs() - begin >= budgetMs)
+			break;
+	}
+	if (this->uploaded < this->requests.size())
+		return false;
+	if (this->finishTime == 0.0)
+		this->finishTime = NowMs();
+	return true;
+}
+
+float AssetLoader::Progress() const
+{
+	if (this->requests.empty())
+		return 1.0f;
+	return this->uploaded / static_cast<float>(this->requests.size());
+}
+
+void AssetLoader::PrintReport() const
+{
+	double decodeTotal = 0.0, uploadTotal = 0.0;
+	unsigned int cacheHits = 0;
+	for (const Request& request : this->requests)
+		std::cout << request.Messages;
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "ASSET_LOADER: " << this->requests.size() << " textures on " << this->jobs.ThreadCount() - 1 << " job threads" << std::endl;
+	for (const Request& request : this->requests)
+	{
+		const char* name = TextureManifest[request.Id].Name;
+		std::cout << "  " << std::left << std::setw(22) << (name != nullptr ? name : "<missing>") << std::right
+			<< " decode " << std::setw(8) << request.DecodeMs << " ms"
+			<< "  upload " << std::setw(7) << request.UploadMs << " ms"
+			<< (request.CacheHit ? "  (cached)" : "") << std::endl;
+		decodeTotal += request.DecodeMs;
+		cacheHits += request.CacheHit ? 1 : 0;
+		uploadTotal += request.UploadMs;
+	}
+	std::cout << "  total decode " << decodeTotal << " ms, upload " << uploadTotal << " ms, wall "
+		<< (this->finishTime - this->startTime) << " ms (" << (cacheHits == this->requests.size() ? "warm" : "cold")
+		<< " cache: " << cacheHits << "/" << this->requests.size() << " hits)" << std::endl;
+}
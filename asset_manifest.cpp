@@ -0,0 +1,32 @@
+#include "asset_manifest.h"
+
+const TextureAsset TextureManifest[TEXTURE_COUNT] = {
+	{ "background",			 "textures/background.jpg",			 false, false },
+	{ "face",				 "textures/awesomeface.png",		 true,  true  },
+	{ "block",				 "textures/block.png",				 true,  false },
+	{ "block_solid",		 "textures/block_solid.png",		 true,  false },
+	{ "paddle",				 "textures/paddle.png",				 true,  false },
+	{ "particle",			 "textures/particle.png",			 true,  true  },
+	{ "powerup_speed",		 "textures/powerup_speed.png",		 true,  false },
+	{ "powerup_sticky",		 "textures/powerup_sticky.png",		 true,  false },
+	{ "powerup_increase",	 "textures/powerup_increase.png",	 true,  false },
+	{ "powerup_confuse",	 "textures/powerup_confuse.png",	 true,  false },
+	{ "powerup_chaos",		 "textures/powerup_chaos.png",		 true,  false },
+	{ "powerup_passthrough", "textures/powerup_passthrough.png", true,  false }
+};
+
+const ShaderAsset ShaderManifest[SHADER_COUNT] = {
+	{ "sprite",			"shaders/sprite.vs",		 "shaders/sprite.frag",			nullptr },
+	{ "particle",		"shaders/particle.vs",		 "shaders/particle.frag",		nullptr },
+	{ "postprocessing", "shaders/postprocessing.vs", "shaders/postprocessing.frag", nullptr },
+	{ "text",			"text_2d.vs",				 "text_2d.fs",					nullptr },
+	{ "brick",			"shaders/brick.vs",			 "shaders/brick.frag",			nullptr }
+};
+
+const AudioAsset AudioManifest[AUDIO_COUNT] = {
+	{ "music",	 "audio/breakout.mp3", false, 1, 0.0f,	1.0f },
+	{ "brick",	 "audio/bleep.mp3",	   true,  4, 30.0f, 1.0f },
+	{ "solid",	 "audio/solid.wav",	   true,  2, 50.0f, 1.0f },
+	{ "powerup", "audio/powerup.wav",  true,  2, 50.0f, 1.0f },
+	{ "paddle",	 "audio/bleep.wav",	   true,  2, 30.0f, 1.0f }
+};
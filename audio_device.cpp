@@ -0,0 +1,21 @@
+#include "audio_device.h"
+
+#include "irrklang_device.h"
+#include "mixer_device.h"
+
+const char* AudioBackendName(AudioBackend backend)
+{
+	static const char* names[AUDIO_BACKEND_COUNT] = { "irrklang", "mixer", "null" };
+	return backend < AUDIO_BACKEND_COUNT ? names[backend] : "unknown";
+}
+
+AudioDevice* CreateAudioDevice(AudioBackend backend, const char* wavFile)
+{
+	if (backend == AUDIO_IRRKLANG)
+		return IrrKlangAudioDevice::Create();
+	if (backend == AUDIO_MIXER)
+		return new MixerAudioDevice(wavFile);
+	if (backend == AUDIO_NULL)
+		return new NullAudioDevice();
+	return nullptr;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#ifndef AUDIO_DEVICE_H
+#define AUDIO_DEVICE_H
+
+#include "asset_manifest.h"
+
+// a playing copy of a sound; 0 is no voice
+typedef unsigned int VoiceHandle;
+
+// the implementations of AudioDevice, picked with --audio=
+enum AudioBackend {
+	AUDIO_IRRKLANG, // irrKlang's own output, the default
+	AUDIO_MIXER,	// the built-in software mixer, see MixerAudioDevice
+	AUDIO_NULL,		// plays nothing, for headless and benchmark runs
+	AUDIO_BACKEND_COUNT
+};
+
+const char* AudioBackendName(AudioBackend backend);
+
+/// AudioDevice is where sounds are played. The game only talks to it
+/// through SoundBank, from one thread at a time. A device plays a sound
+/// once it was loaded from its manifest entry, and hands out a handle per
+/// voice, which has to be released once the bank is done with it.
+class AudioDevice
+{
+public:
+	virtual ~AudioDevice() { }
+	virtual const char* Name() const = 0;
+	virtual bool Load(AudioID id, const AudioAsset& asset) = 0; // returns false if the sound cannot be played
+	virtual VoiceHandle Play(AudioID id, bool loop) = 0;		  // returns 0 if no voice could be started
+	virtual bool Finished(VoiceHandle voice) = 0;
+	virtual void Release(VoiceHandle voice) = 0;				  // stops the voice if it still plays and frees it
+	virtual void PrintStats() const { }
+};
+
+/// NullAudioDevice accepts every sound and finishes every voice at once.
+class NullAudioDevice : public AudioDevice
+{
+public:
+	const char* Name() const override { return "null"; }
+	bool Load(AudioID, const AudioAsset&) override { return true; }
+	VoiceHandle Play(AudioID, bool) override { return 1; }
+	bool Finished(VoiceHandle) override { return true; }
+	void Release(VoiceHandle) override { }
+};
+
+// creates the device of a backend; wavFile, if given, is where the software mixer also writes what it plays.
+// Returns nullptr if the backend cannot run here, e.g. without a sound card or when built without it
+AudioDevice* CreateAudioDevice(AudioBackend backend, const char* wavFile = nullptr);
+
+#endif
@@ -0,0 +1,86 @@
+#include "autoplayer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// how far off-center the paddle meets the ball at most and at least, as a fraction of half the paddle;
+// a ball sent straight up can bounce between a solid brick and the paddle forever
+const float AUTOPLAYER_MAX_AIM = 0.9f;
+const float AUTOPLAYER_MIN_AIM = 0.2f;
+// seconds the autoplayer aims at the same brick before trying the next one
+const float AUTOPLAYER_TARGET_SECONDS = 4.0f;
+
+BatchAction AutoPlayer::Decide(const GameWorld& world, float dt) const
+{
+	BatchAction action = { 0.0f, 0 };
+	if (world.State != GAME_ACTIVE)
+		return action;
+	if (world.Ball.Stuck)
+	{
+		action.Launch = 1;
+		return action;
+	}
+	float landing = this->PredictLanding(world);
+	float half = world.Player.Size.x / 2.0f;
+	float aim = 0.0f;
+	unsigned int turn = static_cast<unsigned int>(world.Levels[world.Level].Stats.ElapsedTime / AUTOPLAYER_TARGET_SECONDS);
+	const Brick* target = this->target(world, turn);
+	if (target)
+	{
+		// the paddle sets the ball's horizontal speed by where it is hit (see GameWorld::doCollisions), pick
+		// the spot that sends the ball straight at the target
+		float rise = world.Player.Position.y - (target->Position.y + target->Size.y);
+		float slope = (target->Position.x + target->Size.x / 2.0f - landing) / std::max(rise, 1.0f);
+		float hit = slope * std::abs(world.Ball.Velocity.y) / (2.0f * INITIAL_BALL_VELOCITY.x);
+		float side = hit < 0.0f ? -1.0f : 1.0f;
+		// a target too far off to the side for one bounce is hit at a new angle every turn, each one a
+		// different orbit through the level, instead of always at the steepest
+		aim = side * std::max(AUTOPLAYER_MIN_AIM, std::min(AUTOPLAYER_MAX_AIM, std::abs(hit))) * half;
+	}
+	float offset = landing - aim - (world.Player.Position.x + half);
+	action.Move = std::max(-1.0f, std::min(1.0f, offset / (PLAYER_VELOCITY * dt)));
+	return action;
+}
+
+const Brick* AutoPlayer::target(const GameWorld& world, unsigned int turn) const
+{
+	// the lowest brick left has nothing in front of it, unless a solid brick shields it; a ball that keeps
+	// missing it settles into the same orbit, so every few seconds the target moves on to a higher brick
+	const GameLevel& level = world.Levels[world.Level];
+	std::vector<const Brick*>& candidates = this->candidates;
+	candidates.clear();
+	for (const Brick& brick : level.Bricks)
+		if (!brick.Destroyed && !brick.IsSolid)
+			candidates.push_back(&brick);
+	if (candidates.empty())
+		return nullptr;
+	std::sort(candidates.begin(), candidates.end(), [](const Brick* a, const Brick* b)
+	{
+		if (a->Position.y != b->Position.y)
+			return a->Position.y > b->Position.y;
+		return a->Position.x < b->Position.x;
+	});
+	return candidates[turn % candidates.size()];
+}
+
+float AutoPlayer::PredictLanding(const GameWorld& world) const
+{
+	const BallObject& ball = world.Ball;
+	float paddleTop = world.Player.Position.y - 2.0f * ball.Radius; // where the ball's top is when it meets the paddle
+	// a ball on its way up comes down from the top edge; bricks on the way are not foreseen
+	float distance = ball.Velocity.y > 0.0f ? paddleTop - ball.Position.y : ball.Position.y + paddleTop;
+	float speed = std::abs(ball.Velocity.y);
+	float x = ball.Position.x + ball.Radius;
+	if (speed <= 0.0f || distance <= 0.0f)
+		return x;
+	x += ball.Velocity.x * distance / speed;
+	// unfold the bounces off the side walls: the center moves within [radius, width - radius]
+	float span = world.Width - 2.0f * ball.Radius;
+	float folded = std::fmod(x - ball.Radius, 2.0f * span);
+	if (folded < 0.0f)
+		folded += 2.0f * span;
+	if (folded > span)
+		folded = 2.0f * span - folded;
+	return folded + ball.Radius;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#ifndef AUTOPLAYER_H
+#define AUTOPLAYER_H
+
+#include <vector>
+
+#include "game_world.h"
+#include "game_batch.h"
+
+/// AutoPlayer plays Breakout on its own, for soak and performance tests.
+/// Every step it predicts where the ball will come down, folding its
+/// flight at the side walls and ignoring bricks, and moves the paddle
+/// there, meeting it off-center so it bounces towards a brick: the
+/// lowest one left, or a higher one once the level clock says it has
+/// been missing that for a while. A ball stuck to the paddle is launched
+/// right away. The same world always gets the same answer, but one
+/// AutoPlayer must only be used by one thread at a time.
+class AutoPlayer
+{
+public:
+	BatchAction Decide(const GameWorld& world, float dt) const; // what to do during the next step of world
+	float PredictLanding(const GameWorld& world) const;			// x of the ball's center once it is back at the paddle
+private:
+	mutable std::vector<const Brick*> candidates; // bricks that can be aimed at, reused every step
+	const Brick* target(const GameWorld& world, unsigned int turn) const; // the brick to send the ball at, null once none is left
+};
+
+#endif
@@ -0,0 +1,344 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "timer.h"
+#include "gpu_timer.h"
+#include "resource_manager.h"
+#include "sprite_renderer.h"
+#include "brick_renderer.h"
+#include "stream_buffer.h"
+#include "particle_generator.h"
+#include "job_system.h"
+#include "game_batch.h"
+#include "mixer_device.h"
+
+// frames rendered after a mode switch before measuring, so the rebuilt framebuffers and driver caches settle
+const unsigned int BENCHMARK_WARMUP_FRAMES = 30;
+// synthetic level for comparing the brick draw paths: a grid of this many tiles per side, 10k bricks
+const unsigned int BENCHMARK_BRICK_GRID = 100;
+const unsigned int BENCHMARK_BRICKS_DESTROYED_PER_FRAME = 4;
+// job system scaling: thread counts compared, particles integrated and timed runs per subsystem
+const unsigned int BENCHMARK_JOB_THREADS[] = { 1, 2, 4, 8 };
+const unsigned int BENCHMARK_JOB_THREAD_COUNTS = sizeof(BENCHMARK_JOB_THREADS) / sizeof(BENCHMARK_JOB_THREADS[0]);
+const unsigned int BENCHMARK_JOB_PARTICLES = 100000;
+const unsigned int BENCHMARK_JOB_RUNS = 20;
+// audio: how often the mixer benchmark triggers a sound, in mixer buffers
+const unsigned int BENCHMARK_AUDIO_TRIGGER_BUFFERS = 2;
+// frame preparation: sprites and particles whose vertex and instance data is written per run
+const unsigned int BENCHMARK_PREPARED_INSTANCES = 100000;
+// batch throughput: ticks every game of the batch is stepped per measured thread count
+const unsigned int BENCHMARK_BATCH_TICKS = 1000;
+const unsigned int BENCHMARK_BATCH_GRID = 16; // columns and rows of the observed occupancy grid
+
+static void benchmarkFrame(Game& game, GLFWwindow* window, float dt)
+{
+	glfwPollEvents();
+	game.Update(dt);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	game.Render();
+	glfwSwapBuffers(window);
+}
+
+static void printFrameTimes(const char* name, std::vector<double>& frameMs, const GpuTimer& gpu)
+{
+	std::sort(frameMs.begin(), frameMs.end());
+	double total = 0.0;
+	for (double ms : frameMs)
+		total += ms;
+	std::cout << "  " << std::left << std::setw(9) << name << std::right
+		<< " cpu avg " << total / frameMs.size() << " ms, median " << frameMs[frameMs.size() / 2]
+		<< " ms, worst " << frameMs.back() << " ms | gpu avg " << gpu.AverageMs() << " ms" << std::endl;
+}
+
+// draws a dense synthetic level one sprite per brick and then with one instanced call,
+// destroying a few bricks every frame so the instanced path pays for its buffer updates
+static std::vector<std::vector<unsigned int>> syntheticTiles()
+{
+	std::vector<std::vector<unsigned int>> tiles(BENCHMARK_BRICK_GRID, std::vector<unsigned int>(BENCHMARK_BRICK_GRID));
+	for (unsigned int y = 0; y < BENCHMARK_BRICK_GRID; ++y)
+		for (unsigned int x = 0; x < BENCHMARK_BRICK_GRID; ++x)
+			tiles[y][x] = 1 + (x + y) % 5;
+	return tiles;
+}
+
+static void benchmarkBricks(Game& game, GLFWwindow* window, unsigned int frames)
+{
+	std::vector<std::vector<unsigned int>> tiles = syntheticTiles();
+	StreamBuffer stream(BENCHMARK_BRICK_GRID * BENCHMARK_BRICK_GRID * 6 * 4 * sizeof(float));
+	JobSystem jobs;
+	SpriteRenderer sprites(ResourceManager::GetShader(SHADER_SPRITE), stream, jobs);
+	BrickRenderer instanced(ResourceManager::GetShader(SHADER_BRICK), ResourceManager::GetTexture(TEXTURE_BLOCK),
+		ResourceManager::GetTexture(TEXTURE_BLOCK_SOLID), jobs);
+	std::cout << "BENCHMARK: " << frames << " frames of " << BENCHMARK_BRICK_GRID * BENCHMARK_BRICK_GRID << " bricks" << std::endl;
+	std::vector<double> frameMs(frames);
+	for (unsigned int pass = 0; pass < 2 && !glfwWindowShouldClose(window); ++pass)
+	{
+		GameLevel level;
+		level.LoadTiles(tiles, game.Width, game.Height);
+		GpuTimer gpu;
+		unsigned int next = 0;
+		for (unsigned int i = 0; i < BENCHMARK_WARMUP_FRAMES + frames; ++i)
+		{
+			double start = NowMs();
+			glfwPollEvents();
+			for (unsigned int d = 0; d < BENCHMARK_BRICKS_DESTROYED_PER_FRAME && next < level.Bricks.size(); ++next)
+				if (!level.Bricks[next].IsSolid)
+				{
+					level.DestroyBrick(level.Bricks[next]);
+					++d;
+				}
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+			stream.BeginFrame();
+			gpu.Begin();
+			if (pass == 0)
+				level.Draw(sprites);
+			else
+				instanced.Draw(level);
+			gpu.End();
+			stream.EndFrame();
+			glfwSwapBuffers(window);
+			if (i >= BENCHMARK_WARMUP_FRAMES)
+				frameMs[i - BENCHMARK_WARMUP_FRAMES] = NowMs() - start;
+		}
+		instanced.Forget(level);
+		printFrameTimes(pass == 0 ? "sprites" : "instanced", frameMs, gpu);
+	}
+}
+
+// average time of a run, after one run to warm caches and wake the workers
+static double timeRuns(const std::function<void()>& run)
+{
+	run();
+	double start = NowMs();
+	for (unsigned int i = 0; i < BENCHMARK_JOB_RUNS; ++i)
+		run();
+	return (NowMs() - start) / BENCHMARK_JOB_RUNS;
+}
+
+// times every subsystem that runs on the job system with 1, 2, 4 and 8 threads
+static void benchmarkJobs(Game& game)
+{
+	enum { PARTICLES, BROAD_PHASE, PACKING, DECODING, SUBSYSTEM_COUNT };
+	static const char* names[SUBSYSTEM_COUNT] = { "particles", "broadphase", "packing", "decoding" };
+	double ms[SUBSYSTEM_COUNT][BENCHMARK_JOB_THREAD_COUNTS];
+
+	GameLevel level;
+	level.LoadTiles(syntheticTiles(), game.Width, game.Height);
+	std::vector<BrickInstance> instances(level.Bricks.size());
+	std::vector<unsigned int> overlapping;
+	GameObject emitter(glm::vec2(game.Width / 2.0f, game.Height / 2.0f), glm::vec2(10.0f), Texture2D(), glm::vec3(1.0f), glm::vec2(50.0f));
+	StreamBuffer stream(1024);
+	std::cout << "BENCHMARK: job system, " << BENCHMARK_JOB_PARTICLES << " particles, " << level.Bricks.size()
+		<< " bricks, " << TEXTURE_COUNT << " textures" << std::endl;
+	for (unsigned int t = 0; t < BENCHMARK_JOB_THREAD_COUNTS; ++t)
+	{
+		JobSystem jobs(BENCHMARK_JOB_THREADS[t] - 1);
+		ParticleGenerator particles(ResourceManager::GetShader(SHADER_PARTICLE), ResourceManager::GetTexture(TEXTURE_PARTICLE),
+			BENCHMARK_JOB_PARTICLES, stream, jobs);
+		particles.Update(0.0f, emitter, BENCHMARK_JOB_PARTICLES);
+		// the steps are tiny, so the particles stay alive for every run
+		ms[PARTICLES][t] = timeRuns([&]() { particles.Update(1e-6f, emitter, 0); });
+		ms[BROAD_PHASE][t] = timeRuns([&]() { level.Overlapping(glm::vec2(0.0f), glm::vec2(game.Width, game.Height), jobs, overlapping); });
+		ms[PACKING][t] = timeRuns([&]() { BrickRenderer::Pack(level, instances.data(), jobs); });
+		ms[DECODING][t] = timeRuns([&]()
+		{
+			jobs.ParallelFor(TEXTURE_COUNT, 1, [](unsigned int begin, unsigned int end)
+			{
+				for (unsigned int i = begin; i < end; ++i)
+				{
+					int width, height;
+					if (TextureManifest[i].File == nullptr)
+						continue;
+					unsigned char* data = ResourceManager::DecodeImage(TextureManifest[i].File, TextureManifest[i].Alpha, width, height);
+					if (data != nullptr)
+						ResourceManager::FreeImage(data);
+				}
+			});
+		});
+	}
+	for (unsigned int s = 0; s < SUBSYSTEM_COUNT; ++s)
+	{
+		std::cout << "  " << std::left << std::setw(10) << names[s] << std::right;
+		for (unsigned int t = 0; t < BENCHMARK_JOB_THREAD_COUNTS; ++t)
+		{
+			std::cout << " | " << BENCHMARK_JOB_THREADS[t] << "t " << ms[s][t] << " ms";
+			if (t > 0)
+				std::cout << " (" << std::setprecision(2) << ms[s][0] / ms[s][t] << "x)" << std::setprecision(3);
+		}
+		std::cout << std::endl;
+	}
+}
+
+// times writing the vertex and instance data of a frame with 100k sprites and 100k particles on
+// one thread and on every hardware thread
+static void benchmarkPreparation(Game& game)
+{
+	std::vector<SpriteState> sprites(BENCHMARK_PREPARED_INSTANCES);
+	std::vector<Particle> live(BENCHMARK_PREPARED_INSTANCES);
+	for (unsigned int i = 0; i < BENCHMARK_PREPARED_INSTANCES; ++i)
+	{
+		glm::vec2 position(static_cast<float>(i % game.Width), static_cast<float>(i / game.Width % game.Height));
+		SpriteState sprite = { ResourceManager::GetTexture(TEXTURE_FACE), position, glm::vec2(8.0f), glm::vec3(1.0f),
+			static_cast<float>(i % 360), LAYER_BALL };
+		sprites[i] = sprite;
+		live[i].Position = position;
+		live[i].Life = 1.0f;
+	}
+	// the stream has to hold a whole frame of both
+	StreamBuffer stream(BENCHMARK_PREPARED_INSTANCES * (6 * 4 + 6) * sizeof(float) + 1024);
+	unsigned int threads[2] = { 1, JobSystem::DefaultWorkers() + 1 };
+	double ms[2][2];
+	for (unsigned int t = 0; t < 2; ++t)
+	{
+		JobSystem jobs(threads[t] - 1);
+		SpriteRenderer renderer(ResourceManager::GetShader(SHADER_SPRITE), stream, jobs);
+		ParticleGenerator particles(ResourceManager::GetShader(SHADER_PARTICLE), ResourceManager::GetTexture(TEXTURE_PARTICLE),
+			1, stream, jobs);
+		ms[t][0] = timeRuns([&]()
+		{
+			stream.BeginFrame();
+			renderer.Prepare(sprites.data(), BENCHMARK_PREPARED_INSTANCES);
+			stream.EndFrame();
+		});
+		ms[t][1] = timeRuns([&]()
+		{
+			RenderQueue queue; // only collects the one draw, nothing is submitted
+			stream.BeginFrame();
+			particles.Draw(queue, live);
+			stream.EndFrame();
+		});
+	}
+	std::cout << "BENCHMARK: frame preparation of " << BENCHMARK_PREPARED_INSTANCES << " instances" << std::endl;
+	static const char* names[2] = { "sprites", "particles" };
+	for (unsigned int s = 0; s < 2; ++s)
+		std::cout << "  " << std::left << std::setw(10) << names[s] << std::right << " | 1t " << ms[0][s] << " ms | "
+			<< threads[1] << "t " << ms[1][s] << " ms (" << std::setprecision(2) << ms[0][s] / ms[1][s] << "x)"
+			<< std::setprecision(3) << std::endl;
+}
+
+int RunBenchmark(Game& game, GLFWwindow* window, unsigned int framesPerMode)
+{
+	// finish loading first, nothing is measured until the level can be drawn
+	while (game.Loading() && !glfwWindowShouldClose(window))
+		benchmarkFrame(game, window, 0.0f);
+	if (glfwWindowShouldClose(window))
+		return -1;
+	game.World->State = GAME_ACTIVE;
+	game.SetRenderScale(game.RenderScale); // a moving render scale would blur the comparison
+
+	std::cout << "BENCHMARK: " << framesPerMode << " frames per anti-aliasing mode at render scale " << game.RenderScale << std::endl;
+	std::cout << std::fixed << std::setprecision(3);
+	std::vector<double> frameMs(framesPerMode);
+	for (unsigned int mode = 0; mode < AA_MODE_COUNT && !glfwWindowShouldClose(window); ++mode)
+	{
+		game.SetAntiAliasing(static_cast<AntiAliasing>(mode));
+		for (unsigned int i = 0; i < BENCHMARK_WARMUP_FRAMES; ++i)
+			benchmarkFrame(game, window, 0.0f);
+		for (unsigned int i = 0; i < framesPerMode; ++i)
+		{
+			double start = NowMs();
+			benchmarkFrame(game, window, 0.0f);
+			frameMs[i] = NowMs() - start;
+		}
+		printFrameTimes(AntiAliasingName(static_cast<AntiAliasing>(mode)), frameMs, game.FrameTimer(static_cast<AntiAliasing>(mode)));
+	}
+	benchmarkBricks(game, window, framesPerMode);
+	benchmarkJobs(game);
+	benchmarkPreparation(game);
+	return 0;
+}
+
+// steers every paddle under its ball, as the observations show them, and launches the ball right away
+static void chaseBalls(const GameBatch& batch, std::vector<BatchAction>& actions, float dt)
+{
+	const BatchObservations& seen = batch.Observations();
+	for (unsigned int i = 0; i < batch.Size(); ++i)
+	{
+		float offset = seen.BallX[i] + BALL_RADIUS - (seen.PaddleX[i] + PLAYER_SIZE.x / 2.0f);
+		actions[i].Move = std::max(-1.0f, std::min(1.0f, offset / (PLAYER_VELOCITY * dt)));
+		actions[i].Launch = 1;
+	}
+}
+
+int RunBatchBenchmark(unsigned int games, unsigned int width, unsigned int height)
+{
+	const float dt = 1.0f / SIM_TICK_RATE;
+	const unsigned int threads[2] = { 1, JobSystem::DefaultWorkers() + 1 };
+	std::cout << "BENCHMARK: " << games << " games for " << BENCHMARK_BATCH_TICKS << " ticks each" << std::endl;
+	std::cout << std::fixed << std::setprecision(0);
+	for (unsigned int t = 0; t < 2; ++t)
+	{
+		JobSystem jobs(threads[t] - 1);
+		GameBatch batch(games, width, height, jobs);
+		// the observations, grid included, are written by the step itself and count towards its time
+		std::vector<unsigned char> memory(batch.ObservationBytes(BENCHMARK_BATCH_GRID, BENCHMARK_BATCH_GRID) + OBSERVATION_ALIGNMENT);
+		void* aligned = memory.data();
+		std::size_t space = memory.size();
+		batch.Observe(std::align(OBSERVATION_ALIGNMENT, space - OBSERVATION_ALIGNMENT, aligned, space), BENCHMARK_BATCH_GRID,
+			BENCHMARK_BATCH_GRID);
+		std::vector<BatchAction> actions(games);
+		std::vector<BatchResult> results(games);
+		unsigned int cleared = 0, gameOvers = 0;
+		double stepMs = 0.0;
+		for (unsigned int tick = 0; tick < BENCHMARK_BATCH_TICKS; ++tick)
+		{
+			chaseBalls(batch, actions, dt); // the policy is not part of the measured step
+			double start = NowMs();
+			batch.Step(actions.data(), results.data(), dt);
+			stepMs += NowMs() - start;
+			for (const BatchResult& result : results)
+			{
+				cleared += result.Cleared;
+				gameOvers += result.GameOver;
+			}
+		}
+		double ticksPerSecond = static_cast<double>(games) * BENCHMARK_BATCH_TICKS / (stepMs / 1000.0);
+		std::cout << "  " << std::setw(2) << jobs.ThreadCount() << "t " << ticksPerSecond << " ticks/s, "
+			<< ticksPerSecond / jobs.ThreadCount() << " ticks/s per core (" << cleared << " levels cleared, "
+			<< gameOvers << " games over)" << std::endl;
+	}
+	return 0;
+}
+
+int RunAudioBenchmark(unsigned int seconds, const char* wavFile)
+{
+	MixerAudioDevice mixer(wavFile, false);
+	for (unsigned int i = 0; i < AUDIO_COUNT; ++i)
+		if (!mixer.Load(static_cast<AudioID>(i), AudioManifest[i]))
+			std::cout << "BENCHMARK: " << AudioManifest[i].Name << " stays silent in the mixer" << std::endl;
+	mixer.Play(AUDIO_MUSIC, true);
+	// keep every voice busy: a new effect every few buffers, the oldest one cut once they run out
+	std::vector<VoiceHandle> playing;
+	unsigned int buffers = seconds * MIXER_SAMPLE_RATE / MIXER_BUFFER_FRAMES;
+	double start = NowMs();
+	for (unsigned int b = 0; b < buffers; ++b)
+	{
+		if (b % BENCHMARK_AUDIO_TRIGGER_BUFFERS == 0)
+		{
+			VoiceHandle voice = mixer.Play(static_cast<AudioID>(AUDIO_BRICK + b / BENCHMARK_AUDIO_TRIGGER_BUFFERS % (AUDIO_COUNT - 1)), false);
+			if (voice)
+				playing.push_back(voice);
+			else if (!playing.empty())
+			{
+				mixer.Release(playing.front());
+				playing.erase(playing.begin());
+			}
+		}
+		mixer.Render(MIXER_BUFFER_FRAMES);
+	}
+	double ms = NowMs() - start;
+	for (VoiceHandle voice : playing)
+		mixer.Release(voice);
+	std::cout << "BENCHMARK: " << seconds << " s of audio mixed in " << ms << " ms, "
+		<< seconds * 1000.0 / std::max(ms, 0.001) << "x real time" << std::endl;
+	mixer.PrintStats();
+	return 0;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#include "Game.h"
+
+// RunBenchmark plays the first level with the ball parked on the paddle
+// and renders a fixed number of frames in every anti-aliasing mode,
+// then prints the CPU and GPU frame time per mode. Dynamic resolution
+// is turned off; the scene stays at the starting render scale. It then
+// compares drawing a 10k-brick level sprite by sprite against the
+// instanced BrickRenderer, and times every subsystem running on the
+// JobSystem with 1, 2, 4 and 8 threads, and how long preparing the
+// vertex data of 100k sprites and particles takes on one thread and
+// on all of them. Vsync should be off so the numbers are not
+// clamped to the refresh rate.
+// Returns the process exit code.
+int RunBenchmark(Game& game, GLFWwindow* window, unsigned int framesPerMode);
+
+// RunBatchBenchmark steps a GameBatch of width x height games without
+// a window, every paddle chasing its ball as the batch's observations
+// show it, first on one thread and then on all of them, and prints
+// game ticks per second in total and per core.
+// Returns the process exit code.
+int RunBatchBenchmark(unsigned int games, unsigned int width, unsigned int height);
+
+// RunAudioBenchmark renders a number of seconds of busy gameplay audio
+// with the software mixer on this thread, as fast as it goes, every
+// voice in use. It prints the total mix time and how many times faster
+// than real time that is, then the mixer's average and worst time per
+// buffer. If wavFile is given the result is written there to be
+// listened to.
+// Returns the process exit code.
+int RunAudioBenchmark(unsigned int seconds, const char* wavFile);
+
+#endif
@@ -0,0 +1,153 @@
+#include "brick_renderer.h"
+
+#include <cstddef>
+#include <vector>
+
+#include "uniform_bindings.h"
+
+BrickRenderer::BrickRenderer(Shader shader, Texture2D& block, Texture2D& blockSolid, JobSystem& jobs)
+	: shader(shader), block(block), blockSolid(blockSolid), jobs(jobs), quadVBO(0), paletteUBO(0), paletteGeneration(0), draws(0)
+{
+	float vertices[] = {
+		// pos      // tex
+		0.0f, 1.0f, 0.0f, 1.0f,
+		1.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 0.0f,
+
+		0.0f, 1.0f, 0.0f, 1.0f,
+		1.0f, 1.0f, 1.0f, 1.0f,
+		1.0f, 0.0f, 1.0f, 0.0f
+	};
+	glGenBuffers(1, &this->quadVBO);
+	glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glGenBuffers(1, &this->paletteUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, this->paletteUBO);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(BrickPalette), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+BrickRenderer::~BrickRenderer()
+{
+	for (auto& entry : this->levels)
+	{
+		glDeleteVertexArrays(1, &entry.second.VAO);
+		glDeleteBuffers(1, &entry.second.VBO);
+	}
+	glDeleteBuffers(1, &this->quadVBO);
+	glDeleteBuffers(1, &this->paletteUBO);
+}
+
+void BrickRenderer::Forget(const GameLevel& level)
+{
+	auto it = this->levels.find(level.Generation);
+	if (it != this->levels.end())
+		this->release(it);
+}
+
+void BrickRenderer::release(std::map<unsigned int, LevelBuffers>::iterator it)
+{
+	glDeleteVertexArrays(1, &it->second.VAO);
+	glDeleteBuffers(1, &it->second.VBO);
+	this->levels.erase(it);
+}
+
+void BrickRenderer::Draw(const GameLevel& level)
+{
+	++this->draws;
+	auto it = this->levels.find(level.Generation);
+	if (it == this->levels.end())
+	{
+		if (this->levels.size() >= BRICK_RENDERER_CACHED_LEVELS)
+		{
+			auto oldest = this->levels.begin();
+			for (auto entry = this->levels.begin(); entry != this->levels.end(); ++entry)
+				if (entry->second.LastDraw < oldest->second.LastDraw)
+					oldest = entry;
+			this->release(oldest);
+		}
+		LevelBuffers buffers = { 0, 0, 0, 0, 0 };
+		glGenVertexArrays(1, &buffers.VAO);
+		glGenBuffers(1, &buffers.VBO);
+		// quad corners per vertex, brick attributes per instance
+		glBindVertexArray(buffers.VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+		glBindBuffer(GL_ARRAY_BUFFER, buffers.VBO);
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(BrickInstance), (void*)offsetof(BrickInstance, Position));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(BrickInstance), (void*)offsetof(BrickInstance, Size));
+		glEnableVertexAttribArray(3);
+		glVertexAttribIPointer(3, 3, GL_UNSIGNED_BYTE, sizeof(BrickInstance), (void*)offsetof(BrickInstance, PaletteIndex));
+		for (unsigned int attribute = 1; attribute <= 3; ++attribute)
+			glVertexAttribDivisor(attribute, 1);
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		it = this->levels.insert(std::make_pair(level.Generation, buffers)).first;
+		this->upload(level, it->second);
+	}
+	LevelBuffers& buffers = it->second;
+	buffers.LastDraw = this->draws;
+	if (buffers.Applied < level.DestroyedBricks.size())
+	{
+		// only the alive flags of bricks destroyed since the last draw change
+		static const unsigned char dead = 0;
+		glBindBuffer(GL_ARRAY_BUFFER, buffers.VBO);
+		for (; buffers.Applied < level.DestroyedBricks.size(); ++buffers.Applied)
+			glBufferSubData(GL_ARRAY_BUFFER, level.DestroyedBricks[buffers.Applied] * sizeof(BrickInstance) + offsetof(BrickInstance, Alive), 1, &dead);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	if (buffers.Count == 0)
+		return;
+	if (this->paletteGeneration != level.Generation)
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, this->paletteUBO);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(BrickPalette), &level.Palette);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		this->paletteGeneration = level.Generation;
+	}
+	glBindBufferBase(GL_UNIFORM_BUFFER, PALETTE_BINDING, this->paletteUBO);
+
+	this->shader.Use();
+	glActiveTexture(GL_TEXTURE0);
+	this->block.Bind();
+	glActiveTexture(GL_TEXTURE1);
+	this->blockSolid.Bind();
+	glBindVertexArray(buffers.VAO);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, buffers.Count);
+	glBindVertexArray(0);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void BrickRenderer::Pack(const GameLevel& level, BrickInstance* instances, JobSystem& jobs)
+{
+	jobs.ParallelFor(static_cast<unsigned int>(level.Bricks.size()), BRICK_PACK_JOB_CHUNK,
+		[&level, instances](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i = begin; i < end; ++i)
+		{
+			const Brick& brick = level.Bricks[i];
+			BrickInstance& instance = instances[i];
+			instance.Position = brick.Position;
+			instance.Size = brick.Size;
+			instance.PaletteIndex = brick.PaletteIndex;
+			instance.Solid = brick.IsSolid ? 1 : 0;
+			instance.Alive = brick.Destroyed ? 0 : 1;
+			instance.Padding = 0;
+		}
+	});
+}
+
+void BrickRenderer::upload(const GameLevel& level, LevelBuffers& buffers)
+{
+	std::vector<BrickInstance> instances(level.Bricks.size());
+	Pack(level, instances.data(), this->jobs);
+	glBindBuffer(GL_ARRAY_BUFFER, buffers.VBO);
+	glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(BrickInstance), instances.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	buffers.Count = static_cast<unsigned int>(instances.size());
+	buffers.Applied = static_cast<unsigned int>(level.DestroyedBricks.size());
+}
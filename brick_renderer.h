@@ -0,0 +1,67 @@
+#pragma once
+
+#ifndef BRICK_RENDERER_H
+#define BRICK_RENDERER_H
+
+#include <map>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "shader.h"
+#include "texture.h"
+#include "game_level.h"
+#include "job_system.h"
+
+// one brick as stored in a level's instance buffer (20 bytes)
+struct BrickInstance {
+	glm::vec2	  Position;
+	glm::vec2	  Size;
+	unsigned char PaletteIndex;
+	unsigned char Solid;
+	unsigned char Alive;
+	unsigned char Padding;
+};
+
+// most instance buffers kept at once
+const unsigned int BRICK_RENDERER_CACHED_LEVELS = 8;
+// bricks per job when packing instances; smaller levels are packed on the calling thread
+const unsigned int BRICK_PACK_JOB_CHUNK = 4096;
+
+// BrickRenderer draws all bricks of a level with a single instanced
+// draw call. Every loaded level (GameLevel::Generation, so copies of a
+// level share it) gets its own instance buffer, uploaded when it is
+// first drawn; destroying a brick only rewrites its one-byte alive
+// flag. The least recently drawn buffers are released once more than
+// BRICK_RENDERER_CACHED_LEVELS are kept. Colors come from the level's palette, which is kept in a
+// uniform buffer and rewritten only when another palette is drawn.
+// The buffers are brought up to date lazily in Draw().
+class BrickRenderer
+{
+public:
+	BrickRenderer(Shader shader, Texture2D& block, Texture2D& blockSolid, JobSystem& jobs);
+	~BrickRenderer();
+	// writes one instance per brick of level to instances, in parallel chunks
+	static void Pack(const GameLevel& level, BrickInstance* instances, JobSystem& jobs);
+	void Draw(const GameLevel& level);
+	void Forget(const GameLevel& level); // releases the buffers of a level that is going away
+private:
+	struct LevelBuffers {
+		unsigned int VAO, VBO;
+		unsigned int Count;	   // bricks in the buffer
+		unsigned int Applied;  // entries of GameLevel::DestroyedBricks already written
+		unsigned int LastDraw; // value of draws when the buffer was last drawn
+	};
+	Shader		 shader;
+	Texture2D	 block, blockSolid;
+	JobSystem&	 jobs;
+	unsigned int quadVBO;
+	unsigned int paletteUBO;
+	unsigned int paletteGeneration; // GameLevel::Generation whose palette is in paletteUBO
+	unsigned int draws;
+	std::map<unsigned int, LevelBuffers> levels; // by GameLevel::Generation
+	void upload(const GameLevel& level, LevelBuffers& buffers);
+	void release(std::map<unsigned int, LevelBuffers>::iterator it);
+};
+
+#endif
@@ -0,0 +1,151 @@
+#include "game_batch.h"
+
+#include <algorithm>
+#include <iostream>
+
+// rounds bytes up to whole cache lines
+static std::size_t alignUp(std::size_t bytes)
+{
+	return (bytes + OBSERVATION_ALIGNMENT - 1) / OBSERVATION_ALIGNMENT * OBSERVATION_ALIGNMENT;
+}
+
+GameBatch::GameBatch(unsigned int count, unsigned int width, unsigned int height, JobSystem& jobs, unsigned int seed)
+	: jobs(jobs), brickWords(0), levelArea(width, height / 2)
+{
+	// the layouts are read once and shared by every game
+	std::shared_ptr<const std::vector<GameLevel>> layouts = GameWorld::LoadLayouts(width, height);
+	for (const GameLevel& level : *layouts)
+		this->brickWords = std::max(this->brickWords, static_cast<unsigned int>((level.Bricks.size() + 63) / 64));
+	// a whole number of cache lines per game
+	this->brickWords = (this->brickWords + 7) / 8 * 8;
+	this->worlds.reserve(count);
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		this->worlds.emplace_back(width, height, layouts, seed + i, jobs);
+		this->worlds.back().Start(i % LEVEL_COUNT);
+	}
+}
+
+void GameBatch::Step(const BatchAction* actions, BatchResult* results, float dt)
+{
+	// jobs take whole blocks of games, so their observations never share a cache line
+	unsigned int blocks = (this->Size() + BATCH_JOB_CHUNK - 1) / BATCH_JOB_CHUNK;
+	this->jobs.ParallelFor(blocks, 1, [this, actions, results, dt](unsigned int begin, unsigned int end)
+	{
+		unsigned int last = std::min(end * BATCH_JOB_CHUNK, this->Size());
+		for (unsigned int i = begin * BATCH_JOB_CHUNK; i < last; ++i)
+		{
+			this->stepWorld(this->worlds[i], actions[i], results[i], dt);
+			if (this->observations.BallX)
+				this->observe(i);
+		}
+	});
+}
+
+std::size_t GameBatch::ObservationBytes(unsigned int gridColumns, unsigned int gridRows) const
+{
+	BatchObservations views;
+	return this->layout(nullptr, gridColumns, gridRows, views);
+}
+
+bool GameBatch::Observe(void* memory, unsigned int gridColumns, unsigned int gridRows)
+{
+	this->observations = BatchObservations();
+	if (!memory)
+		return true;
+	if (reinterpret_cast<std::uintptr_t>(memory) % OBSERVATION_ALIGNMENT != 0)
+	{
+		std::cout << "ERROR::GAME_BATCH: observation memory must be aligned to " << OBSERVATION_ALIGNMENT << " bytes" << std::endl;
+		return false;
+	}
+	this->layout(static_cast<unsigned char*>(memory), gridColumns, gridRows, this->observations);
+	for (unsigned int i = 0; i < this->Size(); ++i)
+		this->observe(i);
+	return true;
+}
+
+std::size_t GameBatch::layout(unsigned char* memory, unsigned int gridColumns, unsigned int gridRows,
+	BatchObservations& views) const
+{
+	// every array starts on a cache line, and is padded to whole blocks of games
+	unsigned int games = (this->Size() + BATCH_JOB_CHUNK - 1) / BATCH_JOB_CHUNK * BATCH_JOB_CHUNK;
+	std::size_t offset = 0;
+	auto place = [memory, &offset](std::size_t bytes) -> unsigned char*
+	{
+		unsigned char* start = memory ? memory + offset : nullptr;
+		offset += alignUp(bytes);
+		return start;
+	};
+	views.BallX = reinterpret_cast<float*>(place(games * sizeof(float)));
+	views.BallY = reinterpret_cast<float*>(place(games * sizeof(float)));
+	views.BallVelocityX = reinterpret_cast<float*>(place(games * sizeof(float)));
+	views.BallVelocityY = reinterpret_cast<float*>(place(games * sizeof(float)));
+	views.PaddleX = reinterpret_cast<float*>(place(games * sizeof(float)));
+	views.PowerUps = reinterpret_cast<unsigned int*>(place(games * sizeof(unsigned int)));
+	views.BrickWords = this->brickWords;
+	views.BricksAlive = reinterpret_cast<std::uint64_t*>(place(games * this->brickWords * sizeof(std::uint64_t)));
+	if (gridColumns > 0 && gridRows > 0)
+	{
+		// a game's grid is padded to whole cache lines too
+		views.GridColumns = gridColumns;
+		views.GridRows = gridRows;
+		views.Grid = place(games * alignUp(gridColumns * gridRows));
+	}
+	return offset;
+}
+
+void GameBatch::observe(unsigned int index)
+{
+	const GameWorld& world = this->worlds[index];
+	BatchObservations& views = this->observations;
+	views.BallX[index] = world.Ball.Position.x;
+	views.BallY[index] = world.Ball.Position.y;
+	views.BallVelocityX[index] = world.Ball.Velocity.x;
+	views.BallVelocityY[index] = world.Ball.Velocity.y;
+	views.PaddleX[index] = world.Player.Position.x;
+	unsigned int powerUps = 0;
+	for (const PowerUp& powerUp : world.PowerUps)
+		if (powerUp.Activated)
+			powerUps |= 1u << powerUp.Type;
+	views.PowerUps[index] = powerUps;
+
+	const GameLevel& level = world.Levels[world.Level];
+	std::uint64_t* mask = views.BricksAlive + static_cast<std::size_t>(index) * views.BrickWords;
+	std::fill(mask, mask + views.BrickWords, 0);
+	for (std::size_t b = 0; b < level.Bricks.size(); ++b)
+		if (!level.Bricks[b].Destroyed)
+			mask[b / 64] |= std::uint64_t(1) << (b % 64);
+	if (views.Grid)
+	{
+		std::size_t cells = alignUp(views.GridColumns * views.GridRows);
+		level.Occupancy(this->levelArea, views.GridColumns, views.GridRows, views.Grid + index * cells);
+	}
+}
+
+WorldInput GameBatch::Input(const BatchAction& action, float dt)
+{
+	WorldInput input;
+	float move = std::max(-1.0f, std::min(1.0f, action.Move));
+	input.Left = move < 0.0f ? -move * dt : 0.0f;
+	input.Right = move > 0.0f ? move * dt : 0.0f;
+	input.Launch = action.Launch != 0;
+	return input;
+}
+
+void GameBatch::stepWorld(GameWorld& world, const BatchAction& action, BatchResult& result, float dt)
+{
+	unsigned int lives = world.Lives;
+	world.Step(Input(action, dt), dt);
+
+	result.BricksDestroyed = 0;
+	for (const GameEvent& event : world.Events)
+		result.BricksDestroyed += event.Type == EVENT_BRICK_DESTROYED;
+	result.Cleared = world.State == GAME_WIN;
+	result.GameOver = world.State == GAME_MENU;
+	result.LifeLost = result.GameOver || world.Lives < lives;
+	if (result.Cleared)
+		world.Start(world.Level + 1);
+	else if (result.GameOver)
+		world.Start(world.Level);
+	result.Lives = world.Lives;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#ifndef GAME_BATCH_H
+#define GAME_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "game_world.h"
+#include "job_system.h"
+
+// games stepped per job; a tick of one game is short, so several share the scheduling cost. Their
+// observation floats fill exactly one cache line, so no two jobs ever write to the same line
+const unsigned int BATCH_JOB_CHUNK = 16;
+// every observation array starts on a cache line
+const unsigned int OBSERVATION_ALIGNMENT = 64;
+
+// what one game is told to do for one tick
+struct BatchAction {
+	float		  Move;	  // -1 pushes the paddle left for the whole tick, 1 right, 0 leaves it
+	unsigned char Launch; // non-zero releases the ball
+};
+
+// what happened to one game during one tick
+struct BatchResult {
+	unsigned int  BricksDestroyed;
+	unsigned int  Lives;	// left after the tick
+	unsigned char LifeLost;
+	unsigned char Cleared;	// the level was won; the game moved on to the next one
+	unsigned char GameOver; // the last life was lost; the game restarted the level
+};
+
+/// BatchObservations is a structure-of-arrays view of the state of every
+/// game in a batch, pointing into one block of memory the caller owns.
+/// Entry i of the per-game arrays belongs to game i; the brick mask and
+/// the grid hold BrickWords and GridColumns * GridRows entries per game.
+struct BatchObservations {
+	float*		   BallX;		  // top-left corner of the ball, like its Position
+	float*		   BallY;
+	float*		   BallVelocityX;
+	float*		   BallVelocityY;
+	float*		   PaddleX;		  // left edge of the paddle
+	unsigned int*  PowerUps;	  // bit t is set while a power-up of PowerUpType t is active
+	std::uint64_t* BricksAlive;	  // bit b % 64 of word b / 64 is set while brick b of the current level stands
+	unsigned char* Grid;		  // 1 in the cells holding a live brick, row by row; null without a grid
+	unsigned int   BrickWords;
+	unsigned int   GridColumns, GridRows;
+
+	BatchObservations() : BallX(nullptr), BallY(nullptr), BallVelocityX(nullptr), BallVelocityY(nullptr), PaddleX(nullptr),
+		PowerUps(nullptr), BricksAlive(nullptr), Grid(nullptr), BrickWords(0), GridColumns(0), GridRows(0) { }
+};
+
+/// GameBatch steps many independent GameWorlds in lock-step, spread
+/// over the worker threads of a JobSystem. The actions and results of
+/// a tick are contiguous arrays with one entry per game, in game order.
+/// Every game starts on a level of its own and keeps playing: a
+/// cleared level moves it on to the next, a game over restarts the
+/// level, so no game ever waits in a menu. Game i is seeded with
+/// seed + i, so a batch replays exactly from the same seed and actions.
+/// Once given memory to Observe, each Step ends by writing every game's
+/// state into it, without allocating or copying anything else.
+class GameBatch
+{
+public:
+	GameBatch(unsigned int count, unsigned int width, unsigned int height, JobSystem& jobs, unsigned int seed = 1);
+	unsigned int Size() const { return static_cast<unsigned int>(this->worlds.size()); }
+	GameWorld& World(unsigned int index) { return this->worlds[index]; }
+	// actions and results hold Size() entries each
+	void Step(const BatchAction* actions, BatchResult* results, float dt);
+	static WorldInput Input(const BatchAction& action, float dt); // the action as a world takes it for a step of dt
+	// bytes Observe needs, with a columns x rows occupancy grid per game unless either is 0
+	std::size_t ObservationBytes(unsigned int gridColumns = 0, unsigned int gridRows = 0) const;
+	// lays the observations out in memory, which must hold ObservationBytes and be aligned to
+	// OBSERVATION_ALIGNMENT, and writes the current state; nullptr stops observing
+	bool Observe(void* memory, unsigned int gridColumns = 0, unsigned int gridRows = 0);
+	const BatchObservations& Observations() const { return this->observations; }
+private:
+	std::vector<GameWorld> worlds;
+	JobSystem&			   jobs;
+	unsigned int		   brickWords; // mask words per game, enough for the largest level
+	BatchObservations	   observations;
+	glm::vec2			   levelArea;  // what the occupancy grid covers
+	std::size_t layout(unsigned char* memory, unsigned int gridColumns, unsigned int gridRows, BatchObservations& views) const;
+	void stepWorld(GameWorld& world, const BatchAction& action, BatchResult& result, float dt);
+	void observe(unsigned int index);
+};
+
+#endif
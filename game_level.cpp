@@ -1,85 +1,175 @@
 #include "game_level.h"
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <iostream>
+#include <mutex>
 #include <sstream>
 
+// levels are loaded by many games at once in batch runs
+static std::atomic<unsigned int> nextGeneration(1);
+
+BrickPalette GameLevel::DefaultPalette()
+{
+    BrickPalette palette;
+    for (unsigned int i = 0; i < BRICK_PALETTE_SIZE; ++i)
+        palette.Colors[i] = glm::vec4(1.0f); // original: white
+    palette.Colors[1] = glm::vec4(0.8f, 0.8f, 0.7f, 1.0f); // solid
+    palette.Colors[2] = glm::vec4(0.2f, 0.6f, 1.0f, 1.0f);
+    palette.Colors[3] = glm::vec4(0.0f, 0.7f, 0.0f, 1.0f);
+    palette.Colors[4] = glm::vec4(0.8f, 0.8f, 0.4f, 1.0f);
+    palette.Colors[5] = glm::vec4(1.0f, 0.5f, 0.0f, 1.0f);
+    return palette;
+}
 
 void GameLevel::Load(const char* file, unsigned int levelWidth, unsigned int levelHeight)
 {
-    // clear old data
-    this->Bricks.clear();
     // load from file
     unsigned int tileCode;
-    GameLevel level;
     std::string line;
     std::ifstream fstream(file);
     std::vector<std::vector<unsigned int>> tileData;
+    BrickPalette palette = DefaultPalette();
     if (fstream)
     {
         while (std::getline(fstream, line)) // read each line from level file
         {
             std::istringstream sstream(line);
+            std::string keyword;
+            if (tileData.empty() && (sstream >> keyword) && keyword == "palette")
+            {
+                unsigned int index;
+                glm::vec3 color;
+                if (sstream >> index >> color.r >> color.g >> color.b && index < BRICK_PALETTE_SIZE)
+                    palette.Colors[index] = glm::vec4(color, 1.0f);
+                else
+                    std::cout << "ERROR::LEVEL: Invalid palette entry in " << file << ": " << line << std::endl;
+                continue;
+            }
+            sstream.clear();
+            sstream.seekg(0);
             std::vector<unsigned int> row;
             while (sstream >> tileCode) // read each word separated by spaces
                 row.push_back(tileCode);
             tileData.push_back(row);
         }
-        if (tileData.size() > 0)
-            this->init(tileData, levelWidth, levelHeight);
     }
+    this->LoadTiles(tileData, levelWidth, levelHeight, palette);
+}
+
+void GameLevel::LoadTiles(const std::vector<std::vector<unsigned int>>& tileData, unsigned int levelWidth, unsigned int levelHeight,
+    const BrickPalette& palette)
+{
+    // clear old data
+    this->Bricks.clear();
+    this->Palette = palette;
+    this->DestroyedBricks.clear();
+    this->Stats = LevelStats();
+    this->bricksRemaining = 0;
+    ++this->Revision;
+    this->Generation = nextGeneration++;
+    if (tileData.size() > 0)
+        this->init(tileData, levelWidth, levelHeight);
+}
+
+void GameLevel::Renew()
+{
+    ++this->Revision;
+    this->Generation = nextGeneration++;
 }
 
 void GameLevel::Draw(SpriteRenderer& renderer)
 {
-    for (GameObject& tile : this->Bricks)
+    for (const Brick& tile : this->Bricks)
         if (!tile.Destroyed)
-            tile.Draw(renderer);
+            renderer.DrawSprite(ResourceManager::GetTexture(tile.IsSolid ? TEXTURE_BLOCK_SOLID : TEXTURE_BLOCK), tile.Position, tile.Size, 0.0f,
+                glm::vec3(this->Palette.Colors[tile.PaletteIndex]));
 }
 
-bool GameLevel::IsCompleted()
+void GameLevel::Overlapping(glm::vec2 min, glm::vec2 max, JobSystem& jobs, std::vector<unsigned int>& bricks) const
 {
-    for (GameObject& tile : this->Bricks)
-        if (!tile.IsSolid && !tile.Destroyed)
-            return false;
-    return true;
+    // every chunk gathers its hits on its own; they are joined in chunk order afterwards
+    std::vector<std::pair<unsigned int, std::vector<unsigned int>>> chunks;
+    std::mutex chunksLock;
+    jobs.ParallelFor(static_cast<unsigned int>(this->Bricks.size()), BRICK_OVERLAP_JOB_CHUNK,
+        [this, min, max, &chunks, &chunksLock](unsigned int begin, unsigned int end)
+    {
+        std::vector<unsigned int> hits;
+        for (unsigned int i = begin; i < end; ++i)
+        {
+            const Brick& brick = this->Bricks[i];
+            if (!brick.Destroyed && brick.Position.x <= max.x && brick.Position.x + brick.Size.x >= min.x &&
+                brick.Position.y <= max.y && brick.Position.y + brick.Size.y >= min.y)
+                hits.push_back(i);
+        }
+        std::lock_guard<std::mutex> lock(chunksLock);
+        chunks.push_back(std::make_pair(begin, std::move(hits)));
+    });
+    std::sort(chunks.begin(), chunks.end(),
+        [](const std::pair<unsigned int, std::vector<unsigned int>>& a, const std::pair<unsigned int, std::vector<unsigned int>>& b) { return a.first < b.first; });
+    bricks.clear();
+    for (const auto& chunk : chunks)
+        bricks.insert(bricks.end(), chunk.second.begin(), chunk.second.end());
 }
 
-void GameLevel::init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight)
+void GameLevel::DestroyBrick(Brick& brick)
+{
+    if (brick.IsSolid || brick.Destroyed)
+        return;
+    brick.Destroyed = true;
+    ++this->Revision;
+    this->DestroyedBricks.push_back(static_cast<unsigned int>(&brick - this->Bricks.data()));
+    --this->bricksRemaining;
+    ++this->Stats.BricksDestroyed;
+    if (this->bricksRemaining == 0)
+        this->Stats.ClearTime = this->Stats.ElapsedTime;
+}
+
+void GameLevel::Occupancy(glm::vec2 area, unsigned int columns, unsigned int rows, unsigned char* cells) const
+{
+    std::fill(cells, cells + columns * rows, 0);
+    for (const Brick& brick : this->Bricks)
+    {
+        if (brick.Destroyed)
+            continue;
+        glm::vec2 center = brick.Position + brick.Size / 2.0f;
+        unsigned int x = std::min(static_cast<unsigned int>(std::max(center.x / area.x, 0.0f) * columns), columns - 1);
+        unsigned int y = std::min(static_cast<unsigned int>(std::max(center.y / area.y, 0.0f) * rows), rows - 1);
+        cells[y * columns + x] = 1;
+    }
+}
+
+void GameLevel::Advance(float dt)
+{
+    if (!this->IsCompleted())
+        this->Stats.ElapsedTime += dt;
+}
+
+void GameLevel::init(const std::vector<std::vector<unsigned int>>& tileData, unsigned int levelWidth, unsigned int levelHeight)
 {
     // calculate dimensions
     unsigned int height = tileData.size();
     unsigned int width = tileData[0].size(); // note we can index vector at [0] since this function is only called if height > 0
     float unit_width = levelWidth / static_cast<float>(width), unit_height = levelHeight / height;
-    // initialize level tiles based on tileData		
+    // initialize level tiles based on tileData; the tile code doubles as palette index
     for (unsigned int y = 0; y < height; ++y)
     {
-        for (unsigned int x = 0; x < width; ++x)
+        for (unsigned int x = 0; x < width && x < tileData[y].size(); ++x)
         {
-            // check block type from level data (2D level array)
-            if (tileData[y][x] == 1) // solid
-            {
-                glm::vec2 pos(unit_width * x, unit_height * y);
-                glm::vec2 size(unit_width, unit_height);
-                GameObject obj(pos, size, ResourceManager::GetTexture("block_solid"), glm::vec3(0.8f, 0.8f, 0.7f));
-                obj.IsSolid = true;
-                this->Bricks.push_back(obj);
-            }
-            else if (tileData[y][x] > 1)	// non-solid; now determine its color based on level data
-            {
-                glm::vec3 color = glm::vec3(1.0f); // original: white
-                if (tileData[y][x] == 2)
-                    color = glm::vec3(0.2f, 0.6f, 1.0f);
-                else if (tileData[y][x] == 3)
-                    color = glm::vec3(0.0f, 0.7f, 0.0f);
-                else if (tileData[y][x] == 4)
-                    color = glm::vec3(0.8f, 0.8f, 0.4f);
-                else if (tileData[y][x] == 5)
-                    color = glm::vec3(1.0f, 0.5f, 0.0f);
-
-                glm::vec2 pos(unit_width * x, unit_height * y);
-                glm::vec2 size(unit_width, unit_height);
-                this->Bricks.push_back(GameObject(pos, size, ResourceManager::GetTexture("block"), color));
-            }
+            unsigned int code = tileData[y][x];
+            if (code == 0) // empty
+                continue;
+            Brick brick;
+            brick.Position = glm::vec2(unit_width * x, unit_height * y);
+            brick.Size = glm::vec2(unit_width, unit_height);
+            brick.PaletteIndex = static_cast<unsigned char>(code < BRICK_PALETTE_SIZE ? code : 0);
+            brick.IsSolid = code == 1;
+            brick.Destroyed = false;
+            this->Bricks.push_back(brick);
+            if (!brick.IsSolid)
+                ++this->bricksRemaining;
         }
     }
-}
\ No newline at end of file
+    this->Stats.TotalBricks = this->bricksRemaining;
+}
@@ -10,25 +10,77 @@
 #include "game_object.h"
 #include "sprite_renderer.h"
 #include "resource_manager.h"
+#include "job_system.h"
+
+const unsigned int BRICK_PALETTE_SIZE = 16;
+// bricks per job when searching for overlaps; smaller levels are searched on the calling thread
+const unsigned int BRICK_OVERLAP_JOB_CHUNK = 4096;
+
+// brick colors of a level, laid out as a std140 uniform block (see shaders/brick.vs)
+struct BrickPalette {
+	glm::vec4 Colors[BRICK_PALETTE_SIZE];
+};
+
+// one tile of a level; its color is looked up in the level's palette
+struct Brick {
+	glm::vec2	  Position, Size;
+	unsigned char PaletteIndex;
+	bool		  IsSolid;
+	bool		  Destroyed;
+};
+
+// per-level statistics, kept up to date by GameLevel::DestroyBrick
+struct LevelStats {
+	unsigned int TotalBricks;	 // destructible bricks when the level was loaded
+	unsigned int BricksDestroyed;
+	float		 ElapsedTime;	 // seconds played on this level so far
+	float		 ClearTime;		 // seconds it took to clear the level (0 while not cleared)
+
+	LevelStats() : TotalBricks(0), BricksDestroyed(0), ElapsedTime(0.0f), ClearTime(0.0f) { }
+};
 
 /// GameLevel holds all Tiles as part of a Breakout level and
-/// hosts functionality to Load/Render levels from the harddisk
+/// hosts functionality to Load/Render levels from the harddisk.
+/// A level file may start with palette lines, "palette <index> <r> <g> <b>",
+/// overriding the default brick colors; tile code N uses palette entry N.
 class GameLevel
 {
 public:
 	//level state
-	std::vector<GameObject> Bricks;
+	std::vector<Brick>		Bricks;
+	BrickPalette			Palette;
+	LevelStats				Stats;
+	unsigned int			Revision;		 // bumped whenever the bricks change, so cached renderings of the level can be refreshed
+	unsigned int			Generation;		 // unique per Load, identifies one layout of Bricks
+	std::vector<unsigned int> DestroyedBricks; // indices into Bricks, in the order they were destroyed since Load
 	//constructor
-	GameLevel() {}
+	GameLevel() : Revision(0), Generation(0), bricksRemaining(0) {}
 	//loads level from file
 	void Load(const char* file, unsigned int levelWidth, unsigned int levelHeight);
-	//render level
+	//loads level from tile codes, one row per vector
+	void LoadTiles(const std::vector<std::vector<unsigned int>>& tileData, unsigned int levelWidth, unsigned int levelHeight,
+		const BrickPalette& palette = DefaultPalette());
+	//gives the level a new Generation, for a copy that starts a layout over
+	void Renew();
+	//the colors levels use unless their file overrides them
+	static BrickPalette DefaultPalette();
+	//render level one sprite at a time (BrickRenderer draws it in one call)
 	void Draw(SpriteRenderer& renderer);
+	//collects the indices of live bricks overlapping the box [min, max] into bricks, in ascending order
+	void Overlapping(glm::vec2 min, glm::vec2 max, JobSystem& jobs, std::vector<unsigned int>& bricks) const;
+	//destroys a non-solid brick; the only place bricks should be destroyed so the live count stays valid
+	void DestroyBrick(Brick& brick);
+	//marks the cells of a columns x rows grid over the level's area that hold the center of a live brick
+	void Occupancy(glm::vec2 area, unsigned int columns, unsigned int rows, unsigned char* cells) const;
+	//advances the level clock while the level is being played
+	void Advance(float dt);
 	//check if level is completed (all non-solid tiles are destroyed)
-	bool IsCompleted();
+	bool IsCompleted() const { return this->bricksRemaining == 0; }
 private:
+	//destructible bricks that are still alive
+	unsigned int bricksRemaining;
 	//initialize level from tile data
-	void init(std::vector<std::vector<unsigned int>> tileData,
+	void init(const std::vector<std::vector<unsigned int>>& tileData,
 		unsigned int levelWidth, unsigned int levelHeight);
 };
 #endif GAMELEVEL_H
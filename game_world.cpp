@@ -0,0 +1,440 @@
+#include "game_world.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+#include "resource_manager.h"
+
+const char* const LEVEL_FILES[LEVEL_COUNT] = {
+	"levels/one.txt",
+	"levels/two.txt",
+	"levels/three.txt",
+	"levels/four.txt"
+};
+
+typedef std::tuple<bool, Direction, glm::vec2> Collision;
+
+GameWorld::GameWorld(unsigned int width, unsigned int height, std::shared_ptr<const std::vector<GameLevel>> layouts,
+	unsigned int seed, JobSystem& jobs)
+	: State(GAME_MENU), Levels(*layouts), Level(0), Lives(3), Width(width), Height(height), layouts(layouts), random(seed),
+	jobs(jobs), shakeTime(0.0f)
+{
+	// every world gets its own copies of the levels, so they must not share the renderers' caches either
+	for (GameLevel& level : this->Levels)
+		level.Renew();
+	glm::vec2 playerPos = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
+	this->Player = GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTexture(TEXTURE_PADDLE));
+	glm::vec2 ballPos = playerPos + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -BALL_RADIUS * 2.0f);
+	this->Ball = BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY, ResourceManager::GetTexture(TEXTURE_FACE));
+}
+
+std::shared_ptr<const std::vector<GameLevel>> GameWorld::LoadLayouts(unsigned int width, unsigned int height)
+{
+	std::shared_ptr<std::vector<GameLevel>> layouts = std::make_shared<std::vector<GameLevel>>(LEVEL_COUNT);
+	for (unsigned int i = 0; i < LEVEL_COUNT; ++i)
+		(*layouts)[i].Load(LEVEL_FILES[i], width, height / 2);
+	return layouts;
+}
+
+void GameWorld::Step(const WorldInput& input, float dt)
+{
+	this->Events.clear();
+	this->applyInput(input);
+	this->update(dt);
+}
+
+void GameWorld::Start(unsigned int level)
+{
+	this->Level = level % this->Levels.size();
+	this->ResetLevel();
+	this->ResetPlayer();
+	this->PowerUps.clear();
+	this->Ball.Sticky = this->Ball.PassThrough = false;
+	this->Ball.Color = this->Player.Color = glm::vec3(1.0f);
+	this->Screen = EffectFlags();
+	this->shakeTime = 0.0f;
+	this->State = GAME_ACTIVE;
+}
+
+void GameWorld::applyInput(const WorldInput& input)
+{
+	if (this->State == GAME_MENU)
+	{
+		if (input.Confirm)
+			this->State = GAME_ACTIVE;
+		unsigned int count = static_cast<unsigned int>(this->Levels.size());
+		this->Level = (this->Level + count + input.LevelStep % static_cast<int>(count)) % count;
+	}
+	if (this->State == GAME_WIN)
+	{
+		if (input.Confirm)
+		{
+			this->Screen.Chaos = false;
+			this->State = GAME_MENU;
+		}
+	}
+	if (this->State == GAME_ACTIVE)
+	{
+		//move as far as the paddle was pushed during the step
+		if (input.Left > 0.0f)
+		{
+			float velocity = PLAYER_VELOCITY * input.Left;
+			if (this->Player.Position.x >= 0.0f) {
+				this->Player.Position.x -= velocity;
+				if (this->Ball.Stuck)
+					this->Ball.Position.x -= velocity;
+			}
+		}
+		if (input.Right > 0.0f)
+		{
+			float velocity = PLAYER_VELOCITY * input.Right;
+			if (this->Player.Position.x <= this->Width - this->Player.Size.x) {
+				this->Player.Position.x += velocity;
+				if (this->Ball.Stuck)
+					this->Ball.Position.x += velocity;
+			}
+		}
+		if (input.Launch)
+			this->Ball.Stuck = false;
+	}
+}
+
+void GameWorld::update(float dt)
+{
+	this->Ball.Move(dt, this->Width); // update objects
+	this->doCollisions(); // check for collisions
+	this->collectPowerUps(); // before bricks drop new ones, which keeps the recorded indices valid
+	this->destroyBricks();
+	this->shakeScreen();
+
+	this->updatePowerUps(dt); // update power ups
+
+	if (this->State == GAME_ACTIVE)
+		this->Levels[this->Level].Advance(dt);
+
+	if (this->shakeTime > 0.0f)
+	{
+		this->shakeTime -= dt;
+		if (this->shakeTime <= 0.0f)
+			this->Screen.Shake = false;
+	}
+	// check loss condition
+	if (this->Ball.Position.y >= this->Height) // did ball reach bottom edge?
+	{
+		--this->Lives;
+		if (this->Lives <= 0) { // did the player lose all his lives? : Game over
+			this->ResetLevel();
+			this->State = GAME_MENU;
+		}
+		this->ResetPlayer();
+	}
+	// check win condition
+	if (this->State == GAME_ACTIVE && this->Levels[this->Level].IsCompleted())
+	{
+		this->LastClear = this->Levels[this->Level].Stats;
+		this->ResetLevel();
+		this->ResetPlayer();
+		this->Screen.Chaos = true;
+		this->State = GAME_WIN;
+	}
+}
+
+void GameWorld::ResetLevel()
+{
+	// a fresh copy of the layout, with a new Generation so cached renderings of the old one are not reused
+	this->Levels[this->Level] = (*this->layouts)[this->Level];
+	this->Levels[this->Level].Renew();
+	this->Lives = 3;
+}
+
+//resets player//ball stats
+void GameWorld::ResetPlayer()
+{
+	this->Player.Size = PLAYER_SIZE;
+	this->Player.Position = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
+	this->Ball.Reset(this->Player.Position + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -(BALL_RADIUS * 2.0f)), INITIAL_BALL_VELOCITY);
+}
+
+bool CheckCollision(const GameObject& one, const GameObject& two)
+{
+	bool collisionX = one.Position.x + one.Size.x >= two.Position.x &&
+		two.Position.x + two.Size.x >= one.Position.x; // collision x-axis?
+	bool collisionY = one.Position.y + one.Size.y >= two.Position.y &&
+		two.Position.y + two.Size.y >= one.Position.y; // collision y-axis?
+	//collision only if on both axes
+	return collisionX && collisionY;
+}
+
+// calculates with direction a vector is facing (N,E,S or W)
+Direction VectorDirection(glm::vec2 target)
+{
+	glm::vec2 compass[] = {
+		glm::vec2(0.0f, 1.0f),  // up
+		glm::vec2(1.0f, 0.0f),	// right
+		glm::vec2(0.0f, -1.0f), //down
+		glm::vec2(-1.0f, 0.0f)  //left
+	};
+	float max = 0.0f;
+	unsigned int best_match = -1;
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		float dot_product = glm::dot(glm::normalize(target), compass[i]);
+		if (dot_product > max)
+		{
+			max = dot_product;
+			best_match = i;
+		}
+	}
+	return (Direction)best_match;
+}
+
+Collision CheckCollision(const BallObject& one, glm::vec2 position, glm::vec2 size)
+{
+	glm::vec2 center(one.Position + one.Radius); // get center point circle first
+	//calculate AABB info (center, half-extents)
+	glm::vec2 aabb_half_extents(size.x / 2.0f, size.y / 2.0f);
+	glm::vec2 aabb_center(
+		position.x + aabb_half_extents.x,
+		position.y + aabb_half_extents.y
+	);
+	glm::vec2 difference = center - aabb_center; // get difference vector between both centers
+	glm::vec2 clamped = glm::clamp(difference, -aabb_half_extents, aabb_half_extents);
+	glm::vec2 closest = aabb_center + clamped;//add a clamped value to AABB_center and we get the value of box closest to the circle
+	difference = closest - center; // retrieve vector between center circle and closest point AABB and check if length <= radius
+
+	if (glm::length(difference) <= one.Radius)
+		return std::make_tuple(true, VectorDirection(difference), difference);
+	else
+		return std::make_tuple(false, UP, glm::vec2(0.0f, 0.0f));
+}
+
+Collision CheckCollision(const BallObject& one, const GameObject& two)
+{
+	return CheckCollision(one, two.Position, two.Size);
+}
+
+void GameWorld::activatePowerUp(PowerUp& powerUp)
+{
+	if (powerUp.Type == POWERUP_SPEED)
+	{
+		this->Ball.Velocity *= 1.2;
+	}
+	else if (powerUp.Type == POWERUP_STICKY)
+	{
+		this->Ball.Sticky = true;
+		this->Player.Color = glm::vec3(1.0f, 0.5f, 1.0f);
+	}
+	else if (powerUp.Type == POWERUP_PASS_THROUGH)
+	{
+		this->Ball.PassThrough = true;
+		this->Ball.Color = glm::vec3(1.0f, 0.5f, 0.5f);
+	}
+	else if (powerUp.Type == POWERUP_PAD_SIZE_INCREASE)
+	{
+		this->Player.Size.x += 50;
+	}
+	else if (powerUp.Type == POWERUP_CONFUSE)
+	{
+		if (!this->Screen.Chaos)
+			this->Screen.Confuse = true; // only activate if chaos wasn't  already active
+	}
+	else if (powerUp.Type == POWERUP_CHAOS)
+	{
+		if (!this->Screen.Confuse)
+			this->Screen.Chaos = true;
+	}
+}
+
+void GameWorld::doCollisions()
+{
+	// broad phase: only bricks around the ball can be hit; the margin covers the ball being pushed out of a brick
+	GameLevel& level = this->Levels[this->Level];
+	glm::vec2 margin(this->Ball.Radius);
+	level.Overlapping(this->Ball.Position - margin, this->Ball.Position + 2.0f * this->Ball.Radius + margin, this->jobs,
+		this->collisionCandidates);
+	for (unsigned int index : this->collisionCandidates)
+	{
+		const Brick& box = level.Bricks[index];
+		if (!box.Destroyed)
+		{
+			Collision collision = CheckCollision(this->Ball, box.Position, box.Size);
+			if (std::get<0>(collision)) // if collision is true
+			{
+				// a brick is only ever a candidate once per step, so it can be destroyed after the loop
+				GameEvent event = { box.IsSolid ? EVENT_SOLID_HIT : EVENT_BRICK_DESTROYED, index, box.Position + box.Size / 2.0f };
+				this->Events.push_back(event);
+				//collision resolution
+				Direction dir = std::get<1>(collision);
+				glm::vec2 diff_vector = std::get<2>(collision);
+				if (!(this->Ball.PassThrough && !box.IsSolid)) { // dont do collision resolution on non-solid bricks if pass-through is activated
+					if (dir == LEFT || dir == RIGHT) // horizontal collision
+					{
+						this->Ball.Velocity.x = -this->Ball.Velocity.x; // reverse horizontal velocity
+						//relocate
+						float penetration = this->Ball.Radius - std::abs(diff_vector.x);
+						if (dir == LEFT)
+							this->Ball.Position.x += penetration; // move ball to right
+						else
+							this->Ball.Position.x -= penetration; // move ball to left
+					}
+					else // vertical collision
+					{
+						this->Ball.Velocity.y = -this->Ball.Velocity.y; // reverse vertical velocity
+						float penetration = this->Ball.Radius - std::abs(diff_vector.y);
+						if (dir == UP)
+							this->Ball.Position.y -= penetration; // move ball back up
+						else
+							this->Ball.Position.y += penetration; // move ball back down
+					}
+				}
+			}
+		}
+	}
+	// also check collisions on Powerups; collected ones are activated by collectPowerUps
+	for (unsigned int i = 0; i < this->PowerUps.size(); ++i) {
+		PowerUp& powerUp = this->PowerUps[i];
+		if (!powerUp.Destroyed)
+		{
+			if (powerUp.Position.y >= this->Height) //first check if powerup passed bottom edge, if so: keep as inactive and destroyed
+				powerUp.Destroyed = true;
+			if (CheckCollision(this->Player, powerUp)) {
+				GameEvent event = { EVENT_POWERUP_COLLECTED, i, powerUp.Position + powerUp.Size / 2.0f };
+				this->Events.push_back(event);
+				powerUp.Destroyed = true;
+			}
+		}
+	}
+	Collision result = CheckCollision(this->Ball, this->Player); // and finally check collisions for player pad(unsless stuck)
+	if (!this->Ball.Stuck && std::get<0>(result))
+	{
+		float centerBoard = this->Player.Position.x + this->Player.Size.x / 2.0f; // check where it hit the board, and change velocity based on where it hit the board
+		float distance = (this->Ball.Position.x + this->Ball.Radius) - centerBoard;
+		float percentage = distance / (this->Player.Size.x / 2.0f);
+		// then move accordingly
+		float strength = 2.0f;
+		glm::vec2 oldVelocity = this->Ball.Velocity;
+		this->Ball.Velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
+		this->Ball.Velocity.y = -1.0f * std::abs(this->Ball.Velocity.y);
+		this->Ball.Velocity = glm::normalize(this->Ball.Velocity) * glm::length(oldVelocity);
+		this->Ball.Stuck = this->Ball.Sticky;
+
+		GameEvent event = { EVENT_PADDLE_HIT, 0, this->Ball.Position + this->Ball.Radius };
+		this->Events.push_back(event);
+	}
+}
+
+void GameWorld::destroyBricks()
+{
+	GameLevel& level = this->Levels[this->Level];
+	for (const GameEvent& event : this->Events)
+		if (event.Type == EVENT_BRICK_DESTROYED)
+		{
+			Brick& box = level.Bricks[event.Index];
+			level.DestroyBrick(box);
+			this->spawnPowerUps(box);
+		}
+}
+
+void GameWorld::collectPowerUps()
+{
+	for (const GameEvent& event : this->Events)
+		if (event.Type == EVENT_POWERUP_COLLECTED)
+		{
+			PowerUp& powerUp = this->PowerUps[event.Index];
+			this->activatePowerUp(powerUp);
+			powerUp.Activated = true;
+		}
+}
+
+void GameWorld::shakeScreen()
+{
+	//a solid block was hit, shake for a moment
+	for (const GameEvent& event : this->Events)
+		if (event.Type == EVENT_SOLID_HIT)
+		{
+			this->shakeTime = 0.05f;
+			this->Screen.Shake = true;
+			return;
+		}
+}
+
+bool GameWorld::shouldSpawn(unsigned int chance)
+{
+	return this->random() % chance == 0;
+}
+
+void GameWorld::spawnPowerUps(const Brick& block)
+{
+	for (unsigned int type = 0; type < POWERUP_TYPE_COUNT; ++type)
+		if (this->shouldSpawn(PowerUpTable[type].SpawnChance))
+			this->PowerUps.push_back(PowerUp(static_cast<PowerUpType>(type), block.Position));
+}
+
+bool IsOtherPowerUpActive(const std::vector<PowerUp>& powerUps, PowerUpType type)
+{
+	for (const PowerUp& powerUp : powerUps)
+	{
+		if (powerUp.Activated)
+			if (powerUp.Type == type)
+				return true;
+	}
+	return false;
+}
+
+void GameWorld::updatePowerUps(float dt) {
+
+	for (PowerUp& powerUp : this->PowerUps)
+	{
+		powerUp.Position += powerUp.Velocity * dt;
+		if (powerUp.Activated)
+		{
+			powerUp.Duration -= dt;
+
+			if (powerUp.Duration <= 0.0f)
+			{
+				// remove powerup from list (will later be removed)
+				powerUp.Activated = false;
+				//deactivate effects
+				if (powerUp.Type == POWERUP_STICKY)
+				{
+					if (!IsOtherPowerUpActive(this->PowerUps, POWERUP_STICKY)) {
+						//only reset if no other powerup of type sticky is active
+						this->Ball.Sticky = false;
+						this->Player.Color = glm::vec3(1.0f);
+					}
+				}
+				else if (powerUp.Type == POWERUP_PASS_THROUGH)
+				{
+					if (!IsOtherPowerUpActive(this->PowerUps, POWERUP_PASS_THROUGH))
+					{
+						//only reset if no other PowerUp of type pass-through is active
+						this->Ball.PassThrough = false;
+						this->Ball.Color = glm::vec3(1.0f);
+					}
+				}
+				else if (powerUp.Type == POWERUP_CONFUSE)
+				{
+					if (!IsOtherPowerUpActive(this->PowerUps, POWERUP_CONFUSE))
+					{
+						//only rest if no other Powerup of type confuse is active
+						this->Screen.Confuse = false;
+					}
+				}
+				else if (powerUp.Type == POWERUP_CHAOS)
+				{
+					if (!IsOtherPowerUpActive(this->PowerUps, POWERUP_CHAOS))
+					{
+						//only reset if no other powerup of type chaos is active
+						this->Screen.Chaos = false;
+					}
+				}
+			}
+		}
+	}
+	// Remove all PowerUps from vector that are destroyed AND !activated (thus either off the map or finished)
+   // Note we use a lambda expression to remove each PowerUp which is destroyed and not activated
+	this->PowerUps.erase(std::remove_if(this->PowerUps.begin(), this->PowerUps.end(),
+		[](const PowerUp& powerUp) { return powerUp.Destroyed && !powerUp.Activated; }
+	), this->PowerUps.end());
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#ifndef GAME_WORLD_H
+#define GAME_WORLD_H
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "game_level.h"
+#include "game_object.h"
+#include "ball_object.h"
+#include "power_up.h"
+#include "job_system.h"
+
+enum GameState {
+	GAME_LOADING, // only while the interactive game uploads its textures
+	GAME_ACTIVE,
+	GAME_MENU,
+	GAME_WIN
+};
+
+enum Direction {
+	UP,
+	RIGHT,
+	DOWN,
+	LEFT
+};
+
+const glm::vec2 PLAYER_SIZE(100.0f, 20.0f); //initial size of the player
+const float PLAYER_VELOCITY(500.0f);		//initial player velocity
+const glm::vec2 INITIAL_BALL_VELOCITY(100.0f, -350.0f);
+const float BALL_RADIUS = 12.5f;
+
+// the levels every world plays, in menu order
+const unsigned int LEVEL_COUNT = 4;
+extern const char* const LEVEL_FILES[LEVEL_COUNT];
+
+// post-processing effects switched by gameplay; the renderer applies them from each snapshot
+struct EffectFlags {
+	bool Chaos, Confuse, Shake;
+
+	EffectFlags() : Chaos(false), Confuse(false), Shake(false) { }
+};
+
+// what can happen to the ball and the paddle during a step
+enum GameEventType {
+	EVENT_BRICK_DESTROYED, // Index is the brick in the current level
+	EVENT_SOLID_HIT,	   // Index is the brick in the current level
+	EVENT_PADDLE_HIT,
+	EVENT_POWERUP_COLLECTED, // Index is the power-up in PowerUps
+	GAME_EVENT_TYPE_COUNT
+};
+
+// one thing that happened during a step; collision only records these, their effects are applied after it
+struct GameEvent {
+	GameEventType Type;
+	unsigned int  Index;
+	glm::vec2	  Position; // where it happened, for the presentation to show it
+};
+
+// what the player did during one step
+struct WorldInput {
+	float Left, Right; // seconds the paddle was pushed each way
+	bool  Launch;	   // releases the ball from the paddle
+	bool  Confirm;	   // starts the selected level in the menu, returns to the menu from the win screen
+	int	  LevelStep;   // moves the menu's level selection by this many levels
+
+	WorldInput() : Left(0.0f), Right(0.0f), Launch(false), Confirm(false), LevelStep(0) { }
+};
+
+/// GameWorld is one game of Breakout: paddle, ball, power-ups, levels
+/// and lives, and the rules that advance them. It owns no GL or audio
+/// resources and uses no global state, so any number of worlds can be
+/// stepped side by side on different threads. Every world draws its
+/// random numbers from its own generator, so a world replays exactly
+/// from the same seed and inputs.
+class GameWorld
+{
+public:
+	GameState			   State;
+	std::vector<GameLevel> Levels;
+	std::vector<PowerUp>   PowerUps;
+	LevelStats			   LastClear; // stats of the most recently cleared level
+	unsigned int		   Level;
+	unsigned int		   Lives;
+	unsigned int		   Width, Height;
+	GameObject			   Player;
+	BallObject			   Ball;
+	EffectFlags			   Screen;
+	std::vector<GameEvent> Events; // what happened during the last step, in order; sounds and particles are up to the owner
+	// the worlds share the level layouts, loaded once with LoadLayouts
+	GameWorld(unsigned int width, unsigned int height, std::shared_ptr<const std::vector<GameLevel>> layouts,
+		unsigned int seed, JobSystem& jobs);
+	static std::shared_ptr<const std::vector<GameLevel>> LoadLayouts(unsigned int width, unsigned int height);
+	void Step(const WorldInput& input, float dt); // applies the input, then advances the world by dt
+	void Start(unsigned int level);				  // restarts a level with full lives and plays it
+	void ResetLevel();
+	void ResetPlayer();
+private:
+	std::shared_ptr<const std::vector<GameLevel>> layouts;
+	std::minstd_rand		  random;
+	JobSystem&				  jobs;
+	float					  shakeTime;
+	std::vector<unsigned int> collisionCandidates; // bricks near the ball, reused every step
+	void applyInput(const WorldInput& input);
+	void update(float dt);
+	void doCollisions(); // moves the ball out of what it hit and records an event for every hit
+	// the passes applying the recorded events, one concern each
+	void destroyBricks();
+	void collectPowerUps();
+	void shakeScreen();
+	bool shouldSpawn(unsigned int chance);
+	void spawnPowerUps(const Brick& block);
+	void activatePowerUp(PowerUp& powerUp);
+	void updatePowerUps(float dt);
+};
+
+#endif
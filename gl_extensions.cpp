@@ -0,0 +1,44 @@
+#include "gl_extensions.h"
+
+#include <cstring>
+
+bool						GLExtensions::ProgramBinary = false;
+PFNGLGETPROGRAMBINARYPROC	GLExtensions::GetProgramBinary = nullptr;
+PFNGLPROGRAMBINARYPROC		GLExtensions::ProgramBinaryFunc = nullptr;
+PFNGLPROGRAMPARAMETERIPROC	GLExtensions::ProgramParameteri = nullptr;
+bool						GLExtensions::BufferStorage = false;
+PFNGLBUFFERSTORAGEPROC		GLExtensions::BufferStorageFunc = nullptr;
+
+void GLExtensions::Load(GLADloadproc load)
+{
+	bool core41 = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 1);
+	if (core41 || HasExtension("GL_ARB_get_program_binary"))
+	{
+		GetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)load("glGetProgramBinary");
+		ProgramBinaryFunc = (PFNGLPROGRAMBINARYPROC)load("glProgramBinary");
+		ProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+		// some drivers expose the extension but support no binary formats at all
+		int formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		ProgramBinary = GetProgramBinary && ProgramBinaryFunc && ProgramParameteri && formats > 0;
+	}
+	bool core44 = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 4);
+	if (core44 || HasExtension("GL_ARB_buffer_storage"))
+	{
+		BufferStorageFunc = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage");
+		BufferStorage = BufferStorageFunc != nullptr;
+	}
+}
+
+bool GLExtensions::HasExtension(const char* name)
+{
+	int count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	for (int i = 0; i < count; ++i)
+	{
+		const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+		if (extension != nullptr && strcmp(extension, name) == 0)
+			return true;
+	}
+	return false;
+}
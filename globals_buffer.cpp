@@ -0,0 +1,31 @@
+#include "globals_buffer.h"
+
+#include "uniform_bindings.h"
+
+static_assert(sizeof(FrameGlobals) == 80, "FrameGlobals must match the std140 layout of the Globals block");
+
+GlobalsBuffer::GlobalsBuffer(const glm::mat4& projection, glm::vec2 viewport)
+	: UBO(0)
+{
+	this->Values.Projection = projection;
+	this->Values.Viewport = viewport;
+	this->Values.Time = 0.0f;
+	this->Values.RenderScale = 1.0f;
+	glGenBuffers(1, &this->UBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, this->UBO);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameGlobals), &this->Values, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, GLOBALS_BINDING, this->UBO);
+}
+
+GlobalsBuffer::~GlobalsBuffer()
+{
+	glDeleteBuffers(1, &this->UBO);
+}
+
+void GlobalsBuffer::Upload()
+{
+	glBindBuffer(GL_UNIFORM_BUFFER, this->UBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameGlobals), &this->Values);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#ifndef GLOBALS_BUFFER_H
+#define GLOBALS_BUFFER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// mirrors the std140 "Globals" uniform block declared by every shader
+struct FrameGlobals {
+	glm::mat4 Projection;	// orthographic projection in game units
+	glm::vec2 Viewport;		// window size in pixels, refreshed every frame
+	float	  Time;			// seconds since start
+	float	  RenderScale;	// fraction of the window size the scene is rendered at
+};
+
+// GlobalsBuffer owns the uniform buffer behind the Globals block. It is
+// bound once to GLOBALS_BINDING; changing a value and calling Upload()
+// updates every program at once.
+class GlobalsBuffer
+{
+public:
+	FrameGlobals Values;
+	GlobalsBuffer(const glm::mat4& projection, glm::vec2 viewport);
+	~GlobalsBuffer();
+	void Upload();
+private:
+	unsigned int UBO;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#include "gpu_timer.h"
+
+GpuTimer::GpuTimer()
+	: LastMs(0.0f), TotalMs(0.0), Samples(0), current(0), measuring(false)
+{
+	glGenQueries(LATENCY * 2, &this->queries[0][0]);
+	for (unsigned int i = 0; i < LATENCY; ++i)
+		this->pending[i] = false;
+}
+
+GpuTimer::~GpuTimer()
+{
+	glDeleteQueries(LATENCY * 2, &this->queries[0][0]);
+}
+
+void GpuTimer::Begin()
+{
+	// read back whatever finished since last time; a slot still in flight is simply not reused this frame
+	for (unsigned int i = 0; i < LATENCY; ++i)
+		if (this->pending[i])
+			this->collect(i);
+	this->measuring = !this->pending[this->current];
+	if (this->measuring)
+		glQueryCounter(this->queries[this->current][0], GL_TIMESTAMP);
+}
+
+void GpuTimer::End()
+{
+	if (!this->measuring)
+		return;
+	glQueryCounter(this->queries[this->current][1], GL_TIMESTAMP);
+	this->pending[this->current] = true;
+	this->current = (this->current + 1) % LATENCY;
+	this->measuring = false;
+}
+
+void GpuTimer::Reset()
+{
+	this->LastMs = 0.0f;
+	this->TotalMs = 0.0;
+	this->Samples = 0;
+}
+
+void GpuTimer::collect(unsigned int slot)
+{
+	unsigned int available = 0;
+	glGetQueryObjectuiv(this->queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+		return;
+	GLuint64 begin, end;
+	glGetQueryObjectui64v(this->queries[slot][0], GL_QUERY_RESULT, &begin);
+	glGetQueryObjectui64v(this->queries[slot][1], GL_QUERY_RESULT, &end);
+	this->LastMs = (end - begin) / 1000000.0f;
+	this->TotalMs += this->LastMs;
+	++this->Samples;
+	this->pending[slot] = false;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <glad/glad.h>
+
+/// GpuTimer measures GPU time between Begin() and End() with timestamp
+/// queries. Results are read a few frames later so timing never stalls
+/// the pipeline; a frame whose query slot is still busy is skipped.
+/// Timestamps (unlike GL_TIME_ELAPSED) allow timers to nest.
+class GpuTimer
+{
+public:
+	float		 LastMs;	// most recent completed measurement
+	double		 TotalMs;	// sum of all completed measurements
+	unsigned int Samples;
+	GpuTimer();
+	~GpuTimer();
+	void Begin();
+	void End();
+	float AverageMs() const { return this->Samples > 0 ? static_cast<float>(this->TotalMs / this->Samples) : 0.0f; }
+	void Reset();
+private:
+	static const unsigned int LATENCY = 4; // frames in flight before a result is read back
+	unsigned int queries[LATENCY][2];
+	bool		 pending[LATENCY];
+	unsigned int current;
+	bool		 measuring;
+	void collect(unsigned int slot);
+};
+
+#endif
@@ -0,0 +1,54 @@
+#pragma once
+
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "asset_manifest.h"
+#include "texture_cache.h"
+#include "job_system.h"
+
+/// AssetLoader decodes manifest textures as jobs, one per texture,
+/// while the game keeps running, reading them from the TextureCache
+/// when a fresh entry exists. Decoded images are handed back to
+/// the GL context thread, which uploads them through Upload() within
+/// a per-frame time budget so a loading screen can keep animating.
+/// Decode and upload times are recorded per asset for the startup report,
+/// along with any problems the decode jobs ran into; only the thread
+/// calling PrintReport prints them.
+class AssetLoader
+{
+public:
+	explicit AssetLoader(JobSystem& jobs);
+	~AssetLoader(); // waits for the decode jobs to finish
+	void QueueTexture(TextureID id);
+	void Start();
+	//uploads decoded textures until budgetMs is spent (at least one per call); returns true once everything queued is uploaded
+	bool Upload(double budgetMs);
+	float Progress() const; // fraction of queued assets that are uploaded
+	bool Failed() const { return this->failed; }
+	void PrintReport() const;
+private:
+	struct Request {
+		TextureID					  Id;
+		std::unique_ptr<TextureImage> Image;
+		bool						  Loaded, CacheHit;
+		double						  DecodeMs, UploadMs;
+		std::string					  Messages; // problems found by the decode job, printed by PrintReport
+	};
+	JobSystem&				 jobs;
+	JobHandle				 decoding;
+	std::vector<Request>	 requests;
+	std::mutex				 readyMutex;
+	std::vector<unsigned int> ready;	   // decoded requests waiting for upload
+	unsigned int			 uploaded;
+	bool					 failed;
+	double					 startTime, finishTime;
+	void decode(unsigned int index);
+};
+
+#endif
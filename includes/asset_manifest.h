@@ -0,0 +1,73 @@
+#pragma once
+
+#ifndef ASSET_MANIFEST_H
+#define ASSET_MANIFEST_H
+
+// Every texture the game uses; the value is the slot in ResourceManager's texture table
+enum TextureID {
+	TEXTURE_BACKGROUND,
+	TEXTURE_FACE,
+	TEXTURE_BLOCK,
+	TEXTURE_BLOCK_SOLID,
+	TEXTURE_PADDLE,
+	TEXTURE_PARTICLE,
+	TEXTURE_POWERUP_SPEED,
+	TEXTURE_POWERUP_STICKY,
+	TEXTURE_POWERUP_INCREASE,
+	TEXTURE_POWERUP_CONFUSE,
+	TEXTURE_POWERUP_CHAOS,
+	TEXTURE_POWERUP_PASSTHROUGH,
+	TEXTURE_COUNT
+};
+
+// Every shader program the game uses; the value is the slot in ResourceManager's shader table
+enum ShaderID {
+	SHADER_SPRITE,
+	SHADER_PARTICLE,
+	SHADER_POSTPROCESSING,
+	SHADER_TEXT,
+	SHADER_BRICK,
+	SHADER_COUNT
+};
+
+// Every sound the game plays; the value is the slot in the SoundBank
+enum AudioID {
+	AUDIO_MUSIC,
+	AUDIO_BRICK,
+	AUDIO_SOLID,
+	AUDIO_POWERUP,
+	AUDIO_PADDLE,
+	AUDIO_COUNT
+};
+
+struct TextureAsset {
+	const char* Name;
+	const char* File;
+	bool		Alpha;
+	bool		Mipmaps; // build a mip chain, for sprites drawn much smaller than their image
+};
+
+struct ShaderAsset {
+	const char* Name;
+	const char* VertexFile;
+	const char* FragmentFile;
+	const char* GeometryFile; // nullptr if the program has no geometry stage
+};
+
+struct AudioAsset {
+	const char*	 Name;
+	const char*	 File;
+	bool		 Preload;	 // decoded up front; otherwise streamed from disk while playing, for music
+	unsigned int MaxVoices;	 // copies of the sound playing at once
+	float		 CoalesceMs; // a trigger this soon after the last one that played is dropped
+	float		 Volume;
+};
+
+/// The asset manifest maps every ID to the file it is loaded from.
+/// Entries must be listed in the same order as the enums above;
+/// Loading reports an error and the game refuses to start if one is missing.
+extern const TextureAsset TextureManifest[TEXTURE_COUNT];
+extern const ShaderAsset  ShaderManifest[SHADER_COUNT];
+extern const AudioAsset	  AudioManifest[AUDIO_COUNT];
+
+#endif
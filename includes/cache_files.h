@@ -0,0 +1,48 @@
+#pragma once
+
+#ifndef CACHE_FILES_H
+#define CACHE_FILES_H
+
+#include <cstdio>
+#include <string>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+// file handling shared by the on-disk caches
+
+// creates every directory along a '/' separated path that does not exist yet
+inline void MakeDirectories(const std::string& path)
+{
+	for (size_t i = 0; i <= path.size(); ++i)
+	{
+		if (i != path.size() && path[i] != '/')
+			continue;
+		std::string dir = path.substr(0, i);
+		if (dir.empty())
+			continue;
+#ifdef _WIN32
+		_mkdir(dir.c_str());
+#else
+		mkdir(dir.c_str(), 0755);
+#endif
+	}
+}
+
+// moves a completely written temporary file over a cache entry; if that fails (typically another
+// writer got there first) the temporary file is removed and false returned
+inline bool CommitCacheFile(const std::string& tempPath, const std::string& entryPath)
+{
+#ifdef _WIN32
+	std::remove(entryPath.c_str()); // rename does not replace an existing file here
+#endif
+	if (std::rename(tempPath.c_str(), entryPath.c_str()) == 0)
+		return true;
+	std::remove(tempPath.c_str());
+	return false;
+}
+
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include "glad/glad.h"
+
+// ARB_get_program_binary (core in GL 4.1)
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT	0x8257
+#define GL_PROGRAM_BINARY_LENGTH			0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS		0x87FE
+
+// ARB_buffer_storage (core in GL 4.4)
+#define GL_MAP_PERSISTENT_BIT				0x0040
+#define GL_MAP_COHERENT_BIT					0x0080
+#define GL_DYNAMIC_STORAGE_BIT				0x0100
+#define GL_CLIENT_STORAGE_BIT				0x0200
+
+typedef void (APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+/// GLExtensions loads the entry points of optional features that the
+/// bundled glad (GL 3.3 core) does not cover. Every feature has a flag
+/// that must be checked before its functions are used.
+class GLExtensions
+{
+public:
+	static bool ProgramBinary; // glGetProgramBinary / glProgramBinary are usable
+	static PFNGLGETPROGRAMBINARYPROC  GetProgramBinary;
+	static PFNGLPROGRAMBINARYPROC	  ProgramBinaryFunc;
+	static PFNGLPROGRAMPARAMETERIPROC ProgramParameteri;
+	static bool BufferStorage; // glBufferStorage is usable, so buffers can be mapped persistently
+	static PFNGLBUFFERSTORAGEPROC	  BufferStorageFunc;
+	//call once after glad has been loaded, with the same loader
+	static void Load(GLADloadproc load);
+	static bool HasExtension(const char* name);
+private:
+	GLExtensions() {}
+};
+
+#endif
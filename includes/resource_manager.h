@@ -3,30 +3,47 @@
 #ifndef RESOURCE_MANAGER_H
 #define RESOURCE_MANAGER_H
 
-#include <map>
 #include <string>
 
 #include "texture.h"
 #include "shader.h"
+#include "asset_manifest.h"
+#include "texture_cache.h"
 
 
 
 class ResourceManager {
 public:
-	//resource storage
-	static std::map<std::string, Shader> Shaders;
-	static std::map<std::string, Texture2D> Textures;
-
-	static Shader LoadShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, std::string name);
-	static Shader& GetShader(std::string name);
-	static Texture2D LoadTexture(const char* file, bool alpha, std::string name);
-	static Texture2D& GetTexture(std::string name);
+	//resource storage, indexed by ShaderID / TextureID
+	static Shader	 Shaders[SHADER_COUNT];
+	static Texture2D Textures[TEXTURE_COUNT];
+
+	//loads every shader listed in the asset manifest; returns false if any of them failed
+	static bool LoadShaders();
+	static Shader LoadShader(ShaderID id);
+	static Shader& GetShader(ShaderID id) { return Shaders[id]; }
+	//compiles the manifest shader with extra #define lines injected after #version; variantName is only used for logging
+	static Shader LoadShaderVariant(ShaderID id, const char* variantName, const std::string& defines);
+	//compiles and links a program from source, going through the program binary cache
+	static Shader CompileShader(const char* name, const std::string& vertexCode, const std::string& fragmentCode, const std::string& geometryCode = "");
+	//creates the GL names of all manifest textures, so objects can hold them before their pixels are uploaded
+	static void ReserveTextures();
+	//decodes and uploads a texture on the calling thread; see AssetLoader for loading in the background
+	static bool LoadTexture(TextureID id);
+	static Texture2D& GetTexture(TextureID id) { return Textures[id]; }
+	//decodes an image into tightly packed RGB or RGBA pixels; safe to call from any thread, free with FreeImage.
+	//A failure is printed, or appended to error as a line if given, for threads that must not print
+	static unsigned char* DecodeImage(const char* file, bool alpha, int& width, int& height, std::string* error = nullptr);
+	static void FreeImage(unsigned char* data);
+	//uploads decoded (or cached) pixels into the texture slot; must be called on the GL context thread
+	static Texture2D& UploadTexture(TextureID id, const TextureImage& image);
 	static void Clear();
 private:
 	ResourceManager() {}
-	static Shader loadShaderFromFile(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile = nullptr);
-	static Texture2D loadTextureFromFile(const char* file, bool alpha);
+	static Shader loadShaderFromFile(const char* name, const char* vShaderFile, const char* fShaderFile, const char* gShaderFile = nullptr);
+	static bool readFile(const char* file, std::string& contents);
+	static bool loadFailed;
 
 };
 
-#endif 
\ No newline at end of file
+#endif 
@@ -17,9 +17,9 @@ class Shader
 {
 public:
 	unsigned int ID;
-	Shader() {}
+	Shader() : ID(0) {}
 	Shader& Use();
-	void Compile(const char* vertexSource, const char* fragmentSource, const char* geometrySource = nullptr);
+	bool Compile(const char* vertexSource, const char* fragmentSource, const char* geometrySource = nullptr);
 
 	void SetFloat	(const char* name, float value, bool useShader = false);
 	void SetInteger (const char* name, int value, bool useShader = false);
@@ -30,8 +30,10 @@ public:
 	void SetVector4f(const char* name, float x, float y, float z, float w, bool useShader = false);
 	void SetVector4f(const char* name, const glm::vec4& value, bool useShader = false);
 	void SetMatrix4	(const char* name, const glm::mat4& matrix, bool useShader = false);
+	//points a uniform block at a buffer binding point; does nothing if the program has no such block
+	void BindUniformBlock(const char* name, unsigned int binding);
 private:
-	void checkCompileErrors(unsigned int object, std::string type);
+	bool checkCompileErrors(unsigned int object, std::string type);
 };
 
 #endif
@@ -0,0 +1,28 @@
+#pragma once
+
+#ifndef SHADER_CACHE_H
+#define SHADER_CACHE_H
+
+#include <cstdint>
+#include <string>
+
+#include "shader.h"
+
+/// ShaderCache stores linked program binaries in Directory so later
+/// launches can skip compiling and linking. Entries are keyed by the
+/// program's sources together with the driver's vendor, renderer and
+/// version strings, since binaries are only valid for the driver that
+/// produced them. Does nothing when GL_ARB_get_program_binary is missing.
+class ShaderCache
+{
+public:
+	static const char* Directory;
+	static uint64_t Key(const std::string& vertexCode, const std::string& fragmentCode, const std::string& geometryCode);
+	//creates shader.ID from a cached binary; false if there is no entry or the driver rejected it
+	static bool Load(uint64_t key, Shader& shader);
+	static void Store(uint64_t key, const Shader& shader);
+private:
+	ShaderCache() {}
+};
+
+#endif
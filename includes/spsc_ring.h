@@ -0,0 +1,42 @@
+#pragma once
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+
+/// SpscRing is a fixed-size queue between exactly one producer thread
+/// and one consumer thread. Push and Pop never block or allocate. Push
+/// fails when the ring is full, leaving the decision to the caller.
+template <typename T, unsigned int CAPACITY>
+class SpscRing
+{
+	static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "SpscRing capacity must be a power of two");
+public:
+	SpscRing() : head(0), tail(0) { }
+	bool Push(const T& value) // producer only
+	{
+		unsigned int t = this->tail.load(std::memory_order_relaxed);
+		if (t - this->head.load(std::memory_order_acquire) == CAPACITY)
+			return false;
+		this->items[t & (CAPACITY - 1)] = value;
+		this->tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+	bool Pop(T& value) // consumer only
+	{
+		unsigned int h = this->head.load(std::memory_order_relaxed);
+		if (h == this->tail.load(std::memory_order_acquire))
+			return false;
+		value = this->items[h & (CAPACITY - 1)];
+		this->head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+private:
+	T items[CAPACITY];
+	// each index is written by one side only; separate cache lines keep the two threads from contending
+	alignas(64) std::atomic<unsigned int> head;
+	alignas(64) std::atomic<unsigned int> tail;
+};
+
+#endif
@@ -21,7 +21,8 @@ public:
 	unsigned int Filter_Min;
 	unsigned int Filter_Max;
 	Texture2D();
-	void Generate(unsigned int width, unsigned int height, unsigned char* data);
+	//uploads the image; with mipLevels > 1, data holds every level back to back using the current GL_UNPACK_ALIGNMENT
+	void Generate(unsigned int width, unsigned int height, const unsigned char* data, unsigned int mipLevels = 1);
 	void Bind() const;
 };
 
@@ -0,0 +1,53 @@
+#pragma once
+
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Pixels ready to be handed to Texture2D::Generate: every mip level
+/// stored back to back, each row padded to RowAlignment bytes. The
+/// pixels either live in a memory mapped cache file or in a buffer
+/// owned by the image; both are released with the image.
+class TextureImage
+{
+public:
+	unsigned int		 Width, Height;
+	unsigned int		 Channels;	   // 3 (RGB) or 4 (RGBA)
+	unsigned int		 MipLevels;
+	unsigned int		 RowAlignment;
+	const unsigned char* Pixels;
+	TextureImage();
+	~TextureImage();
+	void Release();
+private:
+	std::vector<unsigned char> owned;
+	void*	 mapping;	  // platform handle of the mapped cache file
+	size_t	 mappingSize;
+	TextureImage(const TextureImage&);
+	TextureImage& operator=(const TextureImage&);
+	friend class TextureCache;
+};
+
+/// TextureCache keeps decoded textures in Directory as raw, row aligned
+/// (optionally mip mapped) blobs so warm starts skip PNG/JPEG decoding.
+/// Entries are keyed by source path and validated against the source's
+/// modification time, size and content hash; stale entries are rebuilt.
+/// Safe to use from several threads as long as they load different files.
+class TextureCache
+{
+public:
+	static const char* Directory;
+	//fills image from a fresh cache entry (hit = true) or decodes the source and rebuilds the entry; false if the source could not be decoded.
+	//Problems are printed, or stored in messages if given, one line each
+	static bool Load(const char* file, bool alpha, bool mipmaps, TextureImage& image, bool& hit, std::string* messages = nullptr);
+private:
+	TextureCache() {}
+	static bool openEntry(const char* entryPath, const char* file, bool alpha, bool mipmaps, TextureImage& image);
+	static bool buildEntry(const char* entryPath, const char* file, bool alpha, bool mipmaps, TextureImage& image, std::string* messages);
+};
+
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <chrono>
+
+// monotonic wall clock in milliseconds, for startup and frame timings
+inline double NowMs()
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// count, mean and worst of a repeated measurement
+struct TimingStats {
+	unsigned long long Samples;
+	double			   TotalMs, WorstMs;
+
+	TimingStats() : Samples(0), TotalMs(0.0), WorstMs(0.0) { }
+	void Add(double ms)
+	{
+		++this->Samples;
+		this->TotalMs += ms;
+		if (ms > this->WorstMs)
+			this->WorstMs = ms;
+	}
+	double AverageMs() const { return this->Samples > 0 ? this->TotalMs / this->Samples : 0.0; }
+};
+
+#endif
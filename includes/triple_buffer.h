@@ -0,0 +1,38 @@
+#pragma once
+
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+/// TripleBuffer hands the newest value from one writer thread to one
+/// reader thread without locking. The writer fills WriteBuffer() and
+/// calls Publish(); the reader calls Read(), which returns the newest
+/// published value. That value stays unchanged until the reader's next
+/// Read(). Neither side ever waits. If the writer publishes twice
+/// between two reads, the older value is skipped.
+template <typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() : shared(1), write(0), read(2) { }
+	// the value being prepared; it may still hold what was published two or three times ago
+	T& WriteBuffer() { return this->buffers[this->write]; }
+	void Publish()
+	{
+		this->write = this->shared.exchange(this->write | FRESH, std::memory_order_acq_rel) & INDEX;
+	}
+	const T& Read()
+	{
+		if (this->shared.load(std::memory_order_relaxed) & FRESH)
+			this->read = this->shared.exchange(this->read, std::memory_order_acq_rel) & INDEX;
+		return this->buffers[this->read];
+	}
+private:
+	enum { INDEX = 3, FRESH = 4 }; // shared holds the index of the buffer between the threads, and whether it is unread
+	T buffers[3];
+	std::atomic<unsigned int> shared;
+	unsigned int write, read; // owned by the writer and the reader
+};
+
+#endif
@@ -0,0 +1,12 @@
+#pragma once
+
+#ifndef UNIFORM_BINDINGS_H
+#define UNIFORM_BINDINGS_H
+
+// Uniform buffer binding points shared by all programs. GLSL 3.30 can't
+// declare them in the shader, so ResourceManager::CompileShader assigns
+// them by block name after linking.
+const unsigned int GLOBALS_BINDING = 0; // "Globals", see GlobalsBuffer
+const unsigned int PALETTE_BINDING = 1; // "Palette", see BrickRenderer
+
+#endif
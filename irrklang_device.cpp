@@ -0,0 +1,86 @@
+#include "irrklang_device.h"
+
+#ifdef NO_IRRKLANG
+
+IrrKlangAudioDevice* IrrKlangAudioDevice::Create() { return nullptr; }
+IrrKlangAudioDevice::IrrKlangAudioDevice(irrklang::ISoundEngine* engine) : engine(engine), sources() { }
+IrrKlangAudioDevice::~IrrKlangAudioDevice() { }
+bool IrrKlangAudioDevice::Load(AudioID, const AudioAsset&) { return false; }
+VoiceHandle IrrKlangAudioDevice::Play(AudioID, bool) { return 0; }
+bool IrrKlangAudioDevice::Finished(VoiceHandle) { return true; }
+void IrrKlangAudioDevice::Release(VoiceHandle) { }
+
+#else
+
+#include "irrKlang.h"
+
+using namespace irrklang;
+
+IrrKlangAudioDevice* IrrKlangAudioDevice::Create()
+{
+	ISoundEngine* engine = createIrrKlangDevice();
+	return engine ? new IrrKlangAudioDevice(engine) : nullptr;
+}
+
+IrrKlangAudioDevice::IrrKlangAudioDevice(ISoundEngine* engine)
+	: engine(engine), sources()
+{
+}
+
+IrrKlangAudioDevice::~IrrKlangAudioDevice()
+{
+	for (ISound* voice : this->voices)
+		if (voice)
+		{
+			voice->stop();
+			voice->drop();
+		}
+	this->engine->drop();
+}
+
+bool IrrKlangAudioDevice::Load(AudioID id, const AudioAsset& asset)
+{
+	// preloaded sounds are decoded right here, the rest is streamed when played
+	this->sources[id] = this->engine->addSoundSourceFromFile(asset.File, asset.Preload ? ESM_NO_STREAMING : ESM_STREAMING,
+		asset.Preload);
+	if (!this->sources[id])
+		return false;
+	this->sources[id]->setDefaultVolume(asset.Volume);
+	return true;
+}
+
+VoiceHandle IrrKlangAudioDevice::Play(AudioID id, bool loop)
+{
+	if (!this->sources[id])
+		return 0;
+	ISound* sound = this->engine->play2D(this->sources[id], loop, false, true);
+	if (!sound)
+		return 0;
+	if (this->freeVoices.empty())
+	{
+		this->voices.push_back(sound);
+		return static_cast<VoiceHandle>(this->voices.size());
+	}
+	unsigned int index = this->freeVoices.back();
+	this->freeVoices.pop_back();
+	this->voices[index] = sound;
+	return index + 1;
+}
+
+bool IrrKlangAudioDevice::Finished(VoiceHandle voice)
+{
+	return voice == 0 || !this->voices[voice - 1] || this->voices[voice - 1]->isFinished();
+}
+
+void IrrKlangAudioDevice::Release(VoiceHandle voice)
+{
+	if (voice == 0 || !this->voices[voice - 1])
+		return;
+	ISound*& sound = this->voices[voice - 1];
+	sound->stop();
+	sound->drop();
+	sound = nullptr;
+	this->freeVoices.push_back(voice - 1);
+}
+
+#endif
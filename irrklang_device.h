@@ -0,0 +1,37 @@
+#pragma once
+
+#ifndef IRRKLANG_DEVICE_H
+#define IRRKLANG_DEVICE_H
+
+#include <vector>
+
+#include "audio_device.h"
+
+namespace irrklang {
+class ISoundEngine;
+class ISoundSource;
+class ISound;
+}
+
+/// IrrKlangAudioDevice plays through irrKlang, which decodes and mixes
+/// on its own threads. Builds defining NO_IRRKLANG leave it out, and
+/// Create then always fails.
+class IrrKlangAudioDevice : public AudioDevice
+{
+public:
+	static IrrKlangAudioDevice* Create(); // nullptr if irrKlang finds no sound device
+	~IrrKlangAudioDevice() override;
+	const char* Name() const override { return "irrklang"; }
+	bool Load(AudioID id, const AudioAsset& asset) override;
+	VoiceHandle Play(AudioID id, bool loop) override;
+	bool Finished(VoiceHandle voice) override;
+	void Release(VoiceHandle voice) override;
+private:
+	irrklang::ISoundEngine*			engine;
+	irrklang::ISoundSource*			sources[AUDIO_COUNT];
+	std::vector<irrklang::ISound*>	voices;		// a handle is its index + 1; null entries are free
+	std::vector<unsigned int>		freeVoices;
+	explicit IrrKlangAudioDevice(irrklang::ISoundEngine* engine);
+};
+
+#endif
@@ -0,0 +1,227 @@
+#include "job_system.h"
+
+#include <algorithm>
+
+// A unit of work. Its handle is shared by the queue holding it, whoever
+// waits for it and, for the chunks of a parallel for, by its children.
+struct Job : std::enable_shared_from_this<Job> {
+	std::function<void()>  Work;
+	std::atomic<int>	   Unfinished;	  // the job itself and the children it spawned that have not finished
+	std::atomic<int>	   Blockers;	  // unfinished dependencies, plus one while the job is being scheduled
+	JobHandle			   Parent;		  // finished only after this job is
+	std::mutex			   Lock;		  // orders registering continuations against finishing
+	std::atomic<bool>	   Done;
+	std::vector<JobHandle> Continuations; // jobs that depend on this one
+
+	Job() : Unfinished(1), Blockers(0), Done(false) { }
+};
+
+// the queue a thread pushes to and takes from first; a thread is only a worker of the system it was started by
+static thread_local const JobSystem* currentSystem = nullptr;
+static thread_local unsigned int currentQueue = 0;
+
+JobSystem::JobSystem(unsigned int workers)
+	: queued(0), stopping(false)
+{
+	for (unsigned int i = 0; i <= workers; ++i)
+		this->queues.push_back(std::unique_ptr<Queue>(new Queue()));
+	for (unsigned int i = 0; i < workers; ++i)
+		this->workers.push_back(std::thread(&JobSystem::work, this, i + 1));
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->sleepLock);
+		this->stopping = true;
+	}
+	this->wake.notify_all();
+	for (std::thread& worker : this->workers)
+		worker.join();
+}
+
+unsigned int JobSystem::DefaultWorkers()
+{
+	// at least one worker, so jobs nobody waits for (like texture decoding) still make progress
+	unsigned int threads = std::thread::hardware_concurrency();
+	return threads > 1 ? threads - 1 : 1;
+}
+
+JobHandle JobSystem::Schedule(std::function<void()> work, const std::vector<JobHandle>& dependencies)
+{
+	JobHandle job = std::make_shared<Job>();
+	job->Work = std::move(work);
+	this->submit(job, dependencies);
+	return job;
+}
+
+JobHandle JobSystem::ScheduleParallelFor(unsigned int count, unsigned int minChunk, RangeFunc body,
+	const std::vector<JobHandle>& dependencies)
+{
+	JobHandle group = std::make_shared<Job>();
+	Job* self = group.get();
+	std::shared_ptr<RangeFunc> shared = std::make_shared<RangeFunc>(std::move(body));
+	unsigned int chunk = this->chunkSize(count, minChunk);
+	group->Work = [this, self, shared, count, chunk]()
+	{
+		// hand out every chunk but the first, which runs here
+		for (unsigned int begin = chunk; begin < count; begin += chunk)
+		{
+			unsigned int end = std::min(count, begin + chunk);
+			JobHandle part = std::make_shared<Job>();
+			part->Work = [shared, begin, end]() { (*shared)(begin, end); };
+			part->Parent = self->shared_from_this();
+			++self->Unfinished;
+			this->submit(part, std::vector<JobHandle>());
+		}
+		if (count > 0)
+			(*shared)(0, std::min(count, chunk));
+	};
+	this->submit(group, dependencies);
+	return group;
+}
+
+void JobSystem::ParallelFor(unsigned int count, unsigned int minChunk, RangeFunc body)
+{
+	if (count == 0)
+		return;
+	if (this->workers.empty() || count <= minChunk)
+	{
+		body(0, count);
+		return;
+	}
+	this->Wait(this->ScheduleParallelFor(count, minChunk, std::move(body)));
+}
+
+void JobSystem::Wait(const JobHandle& job)
+{
+	while (!this->Finished(job))
+	{
+		JobHandle other = this->next();
+		if (other)
+			this->execute(other);
+		else
+			std::this_thread::yield();
+	}
+}
+
+bool JobSystem::Finished(const JobHandle& job) const
+{
+	return !job || job->Done;
+}
+
+unsigned int JobSystem::chunkSize(unsigned int count, unsigned int minChunk) const
+{
+	unsigned int chunks = this->ThreadCount() * JOB_CHUNKS_PER_THREAD;
+	return std::max(std::max(minChunk, 1u), (count + chunks - 1) / chunks);
+}
+
+void JobSystem::work(unsigned int queue)
+{
+	currentSystem = this;
+	currentQueue = queue;
+	while (!this->stopping)
+	{
+		JobHandle job = this->next();
+		if (job)
+		{
+			this->execute(job);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(this->sleepLock);
+		this->wake.wait(lock, [this]() { return this->queued > 0 || this->stopping; });
+	}
+}
+
+void JobSystem::submit(const JobHandle& job, const std::vector<JobHandle>& dependencies)
+{
+	job->Blockers = 1;
+	for (const JobHandle& dependency : dependencies)
+	{
+		if (!dependency)
+			continue;
+		std::lock_guard<std::mutex> lock(dependency->Lock);
+		if (!dependency->Done)
+		{
+			++job->Blockers;
+			dependency->Continuations.push_back(job);
+		}
+	}
+	this->release(job);
+}
+
+void JobSystem::release(const JobHandle& job)
+{
+	if (--job->Blockers == 0)
+		this->push(job);
+}
+
+void JobSystem::push(const JobHandle& job)
+{
+	Queue& queue = *this->queues[currentSystem == this ? currentQueue : 0];
+	{
+		std::lock_guard<std::mutex> lock(queue.Lock);
+		queue.Jobs.push_back(job);
+		++this->queued;
+	}
+	// taking the lock orders the push against a worker that is about to sleep
+	{
+		std::lock_guard<std::mutex> lock(this->sleepLock);
+	}
+	this->wake.notify_one();
+}
+
+JobHandle JobSystem::next()
+{
+	unsigned int own = currentSystem == this ? currentQueue : 0;
+	{
+		// newest first from the own queue, its data is most likely still in cache
+		Queue& queue = *this->queues[own];
+		std::lock_guard<std::mutex> lock(queue.Lock);
+		if (!queue.Jobs.empty())
+		{
+			JobHandle job = std::move(queue.Jobs.back());
+			queue.Jobs.pop_back();
+			--this->queued;
+			return job;
+		}
+	}
+	// oldest first from the others, those tend to be the larger pieces of work
+	for (unsigned int i = 1; i < this->queues.size(); ++i)
+	{
+		Queue& queue = *this->queues[(own + i) % this->queues.size()];
+		std::lock_guard<std::mutex> lock(queue.Lock);
+		if (!queue.Jobs.empty())
+		{
+			JobHandle job = std::move(queue.Jobs.front());
+			queue.Jobs.pop_front();
+			--this->queued;
+			return job;
+		}
+	}
+	return JobHandle();
+}
+
+void JobSystem::execute(const JobHandle& job)
+{
+	job->Work();
+	job->Work = nullptr; // drop what the work captured now rather than when the last handle goes
+	this->finish(job.get());
+}
+
+void JobSystem::finish(Job* job)
+{
+	if (--job->Unfinished > 0)
+		return;
+	std::vector<JobHandle> continuations;
+	{
+		std::lock_guard<std::mutex> lock(job->Lock);
+		job->Done = true;
+		continuations.swap(job->Continuations);
+	}
+	for (const JobHandle& continuation : continuations)
+		this->release(continuation);
+	JobHandle parent = std::move(job->Parent);
+	if (parent)
+		this->finish(parent.get());
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct Job;
+typedef std::shared_ptr<Job> JobHandle;
+
+// body of a parallel for, called with one chunk [begin, end) of the range
+typedef std::function<void(unsigned int begin, unsigned int end)> RangeFunc;
+
+// chunks a parallel for aims to split its range into per thread, so a slow chunk can be balanced by stealing
+const unsigned int JOB_CHUNKS_PER_THREAD = 4;
+
+/// JobSystem runs small jobs on a pool of worker threads. Every worker
+/// owns a deque: it runs its own newest job first and, once that runs
+/// dry, steals the oldest job of another deque. Threads outside the pool
+/// share one more deque. A job may depend on other jobs and only starts
+/// after all of them have finished. A thread waiting for a job runs
+/// queued jobs meanwhile, so a pool without workers still gets everything
+/// done, on the waiting thread. Jobs must not outlive the JobSystem.
+class JobSystem
+{
+public:
+	explicit JobSystem(unsigned int workers = DefaultWorkers());
+	~JobSystem();
+	static unsigned int DefaultWorkers(); // one per hardware thread, less the thread that waits
+	unsigned int ThreadCount() const { return static_cast<unsigned int>(this->workers.size()) + 1; } // workers and a waiting thread
+	JobHandle Schedule(std::function<void()> work, const std::vector<JobHandle>& dependencies = std::vector<JobHandle>());
+	// splits [0, count) into chunks of at least minChunk items and runs body on every chunk; the
+	// returned job finishes once all chunks have
+	JobHandle ScheduleParallelFor(unsigned int count, unsigned int minChunk, RangeFunc body,
+		const std::vector<JobHandle>& dependencies = std::vector<JobHandle>());
+	// ScheduleParallelFor and Wait; a range that fits one chunk runs right here
+	void ParallelFor(unsigned int count, unsigned int minChunk, RangeFunc body);
+	void Wait(const JobHandle& job);
+	bool Finished(const JobHandle& job) const;
+private:
+	struct Queue {
+		std::mutex			  Lock;
+		std::deque<JobHandle> Jobs;
+	};
+	std::vector<std::thread> workers;
+	std::vector<std::unique_ptr<Queue>> queues; // queues[0] is shared by outside threads, worker i owns queues[i + 1]
+	std::atomic<int>		 queued;			// jobs sitting in any queue
+	std::atomic<bool>		 stopping;
+	std::mutex				 sleepLock;
+	std::condition_variable	 wake;
+	void work(unsigned int queue);
+	void submit(const JobHandle& job, const std::vector<JobHandle>& dependencies);
+	void push(const JobHandle& job);
+	JobHandle next(); // a job of the calling thread's queue, or one stolen from another
+	void execute(const JobHandle& job);
+	void finish(Job* job);
+	void release(const JobHandle& job); // one of job's blockers is gone
+	unsigned int chunkSize(unsigned int count, unsigned int minChunk) const;
+};
+
+#endif
@@ -0,0 +1,340 @@
+#include "mixer_device.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIXER_SSE2
+#endif
+
+// adds count samples of a voice to the mix
+static void mixInto(float* out, const float* in, size_t count)
+{
+	size_t i = 0;
+#ifdef MIXER_SSE2
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_loadu_ps(in + i)));
+#endif
+	for (; i < count; ++i)
+		out[i] += in[i];
+}
+
+// converts the mix to 16 bit samples, clipping what is too loud
+static void toPcm(const float* in, short* out, size_t count)
+{
+	size_t i = 0;
+#ifdef MIXER_SSE2
+	const __m128 scale = _mm_set1_ps(32767.0f);
+	for (; i + 8 <= count; i += 8)
+	{
+		// the conversion to 32 bit may overflow for very loud mixes, so clamp first; it truncates like the
+		// scalar loop below, so builds with and without SSE2 write the same samples
+		__m128 low = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(in + i), _mm_set1_ps(1.0f)), _mm_set1_ps(-1.0f));
+		__m128 high = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(in + i + 4), _mm_set1_ps(1.0f)), _mm_set1_ps(-1.0f));
+		__m128i packed = _mm_packs_epi32(_mm_cvttps_epi32(_mm_mul_ps(low, scale)), _mm_cvttps_epi32(_mm_mul_ps(high, scale)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+	}
+#endif
+	for (; i < count; ++i)
+		out[i] = static_cast<short>(std::max(-1.0f, std::min(1.0f, in[i])) * 32767.0f);
+}
+
+MixerAudioDevice::MixerAudioDevice(const char* wavFile, bool threaded)
+	: commandMemory(sizeof(CommandRing) + alignof(CommandRing)), held(), generations(), voices(), mixed(MIXER_BUFFER_FRAMES * MIXER_CHANNELS), pcm(MIXER_BUFFER_FRAMES * MIXER_CHANNELS),
+	wav(nullptr), framesWritten(0), running(false), underruns(0)
+{
+	void* memory = this->commandMemory.data();
+	std::size_t space = this->commandMemory.size();
+	this->commands = new (std::align(alignof(CommandRing), sizeof(CommandRing), memory, space)) CommandRing();
+	for (unsigned int slot = 0; slot < MIXER_VOICES; ++slot)
+	{
+		this->busy[slot] = false;
+		this->stopping[slot] = false;
+	}
+	if (wavFile)
+	{
+		this->wav = std::fopen(wavFile, "wb");
+		if (this->wav)
+			this->writeWavHeader(); // rewritten with the final sizes once done
+		else
+			std::cout << "ERROR::MIXER: Failed to open " << wavFile << " for writing" << std::endl;
+	}
+	if (threaded)
+	{
+		this->running = true;
+		this->mixer = std::thread(&MixerAudioDevice::run, this);
+	}
+}
+
+MixerAudioDevice::~MixerAudioDevice()
+{
+	if (this->running)
+	{
+		this->running = false;
+		this->mixer.join();
+	}
+	if (this->wav)
+	{
+		std::fseek(this->wav, 0, SEEK_SET);
+		this->writeWavHeader();
+		std::fclose(this->wav);
+	}
+	this->commands->~CommandRing();
+}
+
+bool MixerAudioDevice::Load(AudioID id, const AudioAsset& asset)
+{
+	return loadWav(asset.File, asset.Volume, this->sounds[id]);
+}
+
+VoiceHandle MixerAudioDevice::Play(AudioID id, bool loop)
+{
+	if (this->sounds[id].empty())
+		return 0;
+	for (unsigned int slot = 0; slot < MIXER_VOICES; ++slot)
+	{
+		if (this->held[slot] || this->busy[slot].load(std::memory_order_acquire))
+			continue;
+		Command command = { slot, id, loop };
+		this->busy[slot].store(true, std::memory_order_relaxed);
+		// a Release racing the voice's natural end may have left the flag behind; the push publishes the reset
+		this->stopping[slot].store(false, std::memory_order_relaxed);
+		if (!this->commands->Push(command))
+		{
+			this->busy[slot].store(false, std::memory_order_relaxed);
+			return 0;
+		}
+		this->held[slot] = true;
+		++this->generations[slot];
+		return (this->generations[slot] << 8) | (slot + 1);
+	}
+	return 0;
+}
+
+bool MixerAudioDevice::Finished(VoiceHandle voice)
+{
+	unsigned int slot = (voice & 0xff) - 1;
+	if (voice == 0 || slot >= MIXER_VOICES || (voice >> 8) != (this->generations[slot] & 0xffffff))
+		return true;
+	return !this->busy[slot].load(std::memory_order_acquire);
+}
+
+void MixerAudioDevice::Release(VoiceHandle voice)
+{
+	unsigned int slot = (voice & 0xff) - 1;
+	if (voice == 0 || slot >= MIXER_VOICES || (voice >> 8) != (this->generations[slot] & 0xffffff) || !this->held[slot])
+		return;
+	this->held[slot] = false;
+	// the slot is only reused once the mixer has let go of it; a flag rather than a command, so stopping
+	// can't fail on a full queue and leave a looping voice playing for good
+	if (this->busy[slot].load(std::memory_order_acquire))
+		this->stopping[slot].store(true, std::memory_order_release);
+}
+
+void MixerAudioDevice::Render(unsigned int frames)
+{
+	if (this->running)
+		return;
+	for (unsigned int done = 0; done < frames; done += MIXER_BUFFER_FRAMES)
+		this->mixBuffer();
+}
+
+void MixerAudioDevice::run()
+{
+	const double bufferMs = 1000.0 * MIXER_BUFFER_FRAMES / MIXER_SAMPLE_RATE;
+	double deadline = NowMs() + bufferMs; // one buffer is always queued ahead of the one playing
+	while (this->running)
+	{
+		this->mixBuffer();
+		double end = NowMs();
+		if (end > deadline)
+		{
+			std::lock_guard<std::mutex> lock(this->statsLock);
+			++this->underruns;
+			deadline = end; // start over from here rather than rushing to catch up
+		}
+		else
+			std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(deadline - end));
+		deadline += bufferMs;
+	}
+}
+
+void MixerAudioDevice::mixBuffer()
+{
+	double start = NowMs();
+	Command command;
+	while (this->commands->Pop(command))
+	{
+		Voice& voice = this->voices[command.Slot];
+		const std::vector<float>& samples = this->sounds[command.Id];
+		voice.Samples = samples.data();
+		voice.Length = samples.size();
+		voice.Position = 0;
+		voice.Loop = command.Loop;
+		voice.Active = true;
+	}
+	for (unsigned int slot = 0; slot < MIXER_VOICES; ++slot)
+		if (this->voices[slot].Active && this->stopping[slot].exchange(false, std::memory_order_acquire))
+		{
+			this->voices[slot].Active = false;
+			this->busy[slot].store(false, std::memory_order_release);
+		}
+
+	std::fill(this->mixed.begin(), this->mixed.end(), 0.0f);
+	for (unsigned int slot = 0; slot < MIXER_VOICES; ++slot)
+	{
+		Voice& voice = this->voices[slot];
+		size_t offset = 0;
+		while (voice.Active && offset < this->mixed.size())
+		{
+			size_t count = std::min(this->mixed.size() - offset, voice.Length - voice.Position);
+			mixInto(this->mixed.data() + offset, voice.Samples + voice.Position, count);
+			offset += count;
+			voice.Position += count;
+			if (voice.Position < voice.Length)
+				continue;
+			if (voice.Loop)
+				voice.Position = 0;
+			else
+			{
+				voice.Active = false;
+				this->busy[slot].store(false, std::memory_order_release);
+			}
+		}
+	}
+	toPcm(this->mixed.data(), this->pcm.data(), this->pcm.size());
+	double ms = NowMs() - start;
+	{
+		std::lock_guard<std::mutex> lock(this->statsLock);
+		this->mixTimes.Add(ms);
+	}
+	if (this->wav)
+	{
+		std::fwrite(this->pcm.data(), sizeof(short), this->pcm.size(), this->wav);
+		this->framesWritten += MIXER_BUFFER_FRAMES;
+	}
+}
+
+void MixerAudioDevice::PrintStats() const
+{
+	std::lock_guard<std::mutex> lock(this->statsLock);
+	std::cout << "MIXER: " << this->mixTimes.Samples << " buffers of " << MIXER_BUFFER_FRAMES << " frames, mixed in "
+		<< this->mixTimes.AverageMs() * 1000.0 << " us avg, " << this->mixTimes.WorstMs * 1000.0 << " us worst; "
+		<< this->underruns << " under-runs" << std::endl;
+}
+
+// little-endian fields of RIFF files
+static void putU32(unsigned char* out, unsigned int value)
+{
+	for (int i = 0; i < 4; ++i)
+		out[i] = static_cast<unsigned char>(value >> (8 * i));
+}
+
+static void putU16(unsigned char* out, unsigned int value)
+{
+	out[0] = static_cast<unsigned char>(value);
+	out[1] = static_cast<unsigned char>(value >> 8);
+}
+
+static unsigned int getU32(const unsigned char* in)
+{
+	return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<unsigned int>(in[3]) << 24);
+}
+
+static unsigned int getU16(const unsigned char* in)
+{
+	return in[0] | (in[1] << 8);
+}
+
+void MixerAudioDevice::writeWavHeader()
+{
+	unsigned int dataBytes = static_cast<unsigned int>(this->framesWritten * MIXER_CHANNELS * sizeof(short));
+	unsigned char header[44];
+	std::memcpy(header, "RIFF", 4);
+	putU32(header + 4, 36 + dataBytes);
+	std::memcpy(header + 8, "WAVEfmt ", 8);
+	putU32(header + 16, 16);
+	putU16(header + 20, 1); // PCM
+	putU16(header + 22, MIXER_CHANNELS);
+	putU32(header + 24, MIXER_SAMPLE_RATE);
+	putU32(header + 28, MIXER_SAMPLE_RATE * MIXER_CHANNELS * sizeof(short));
+	putU16(header + 32, MIXER_CHANNELS * sizeof(short));
+	putU16(header + 34, 16);
+	std::memcpy(header + 36, "data", 4);
+	putU32(header + 40, dataBytes);
+	std::fwrite(header, 1, sizeof(header), this->wav);
+}
+
+bool MixerAudioDevice::loadWav(const char* file, float volume, std::vector<float>& samples)
+{
+	std::FILE* in = std::fopen(file, "rb");
+	if (!in)
+	{
+		std::cout << "ERROR::MIXER: Failed to open " << file << std::endl;
+		return false;
+	}
+	std::vector<unsigned char> bytes;
+	unsigned char chunk[4096];
+	for (size_t read; (read = std::fread(chunk, 1, sizeof(chunk), in)) > 0;)
+		bytes.insert(bytes.end(), chunk, chunk + read);
+	std::fclose(in);
+	if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 || std::memcmp(bytes.data() + 8, "WAVE", 4) != 0)
+	{
+		std::cout << "ERROR::MIXER: " << file << " is not a WAV file, only those can be mixed" << std::endl;
+		return false;
+	}
+	// walk the chunks for the format and the samples
+	unsigned int format = 0, channels = 0, rate = 0, bits = 0;
+	const unsigned char* data = nullptr;
+	size_t dataBytes = 0;
+	for (size_t at = 12; at + 8 <= bytes.size();)
+	{
+		size_t size = std::min<size_t>(getU32(&bytes[at + 4]), bytes.size() - at - 8);
+		const unsigned char* body = &bytes[at + 8];
+		if (std::memcmp(&bytes[at], "fmt ", 4) == 0 && size >= 16)
+		{
+			format = getU16(body);
+			channels = getU16(body + 2);
+			rate = getU32(body + 4);
+			bits = getU16(body + 14);
+		}
+		else if (std::memcmp(&bytes[at], "data", 4) == 0)
+		{
+			data = body;
+			dataBytes = size;
+		}
+		at += 8 + size + (size & 1);
+	}
+	if (format != 1 || (channels != 1 && channels != 2) || (bits != 8 && bits != 16) || rate == 0 || !data)
+	{
+		std::cout << "ERROR::MIXER: " << file << " is not 8 or 16 bit mono or stereo PCM" << std::endl;
+		return false;
+	}
+	unsigned int frameBytes = channels * bits / 8;
+	size_t frames = dataBytes / frameBytes;
+	auto sample = [&](size_t frame, unsigned int channel) -> float
+	{
+		const unsigned char* at = data + frame * frameBytes + (channel % channels) * (bits / 8);
+		if (bits == 8)
+			return (at[0] - 128) / 128.0f;
+		return static_cast<short>(getU16(at)) / 32768.0f;
+	};
+	// resample to the mixer's rate and channels once, here, so mixing only ever adds
+	size_t outFrames = static_cast<size_t>(static_cast<double>(frames) * MIXER_SAMPLE_RATE / rate);
+	samples.resize(outFrames * MIXER_CHANNELS);
+	for (size_t f = 0; f < outFrames; ++f)
+	{
+		double position = static_cast<double>(f) * rate / MIXER_SAMPLE_RATE;
+		size_t first = std::min(static_cast<size_t>(position), frames - 1);
+		size_t second = std::min(first + 1, frames - 1);
+		float blend = static_cast<float>(position - first);
+		for (unsigned int c = 0; c < MIXER_CHANNELS; ++c)
+			samples[f * MIXER_CHANNELS + c] = volume * (sample(first, c) + (sample(second, c) - sample(first, c)) * blend);
+	}
+	return true;
+}
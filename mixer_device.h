@@ -0,0 +1,81 @@
+#pragma once
+
+#ifndef MIXER_DEVICE_H
+#define MIXER_DEVICE_H
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "audio_device.h"
+#include "spsc_ring.h"
+#include "timer.h"
+
+const unsigned int MIXER_SAMPLE_RATE = 44100;
+const unsigned int MIXER_CHANNELS = 2;
+const unsigned int MIXER_BUFFER_FRAMES = 512;		// ~11.6 ms; a buffer must be mixed before the previous one has played
+const unsigned int MIXER_VOICES = 32;				// at most 255, handles keep the slot in their low byte
+const unsigned int MIXER_COMMAND_QUEUE_SIZE = 256;	// play requests waiting for the mixer
+
+/// MixerAudioDevice mixes sounds itself, with SSE2 where available. It
+/// decodes 8 and 16 bit PCM WAV files into float samples at load time;
+/// other formats stay silent. Play only queues a command on a lock-free
+/// ring and Release only raises a flag; a mixer thread takes both up
+/// between buffers, mixes one
+/// buffer every MIXER_BUFFER_FRAMES frames and counts an under-run
+/// whenever a buffer was not ready in time. Everything mixed can also be
+/// written to a WAV file. Without a thread, Render mixes on the caller's
+/// thread as fast as it can, which makes the output reproducible.
+class MixerAudioDevice : public AudioDevice
+{
+public:
+	explicit MixerAudioDevice(const char* wavFile = nullptr, bool threaded = true);
+	~MixerAudioDevice() override;
+	const char* Name() const override { return "mixer"; }
+	bool Load(AudioID id, const AudioAsset& asset) override; // call before the sound is first played
+	VoiceHandle Play(AudioID id, bool loop) override;
+	bool Finished(VoiceHandle voice) override;
+	void Release(VoiceHandle voice) override;
+	void Render(unsigned int frames); // mixes at least this many frames right away; only without a thread
+	void PrintStats() const override;
+private:
+	struct Command {
+		unsigned int Slot;
+		AudioID		 Id;
+		bool		 Loop;
+	};
+	struct Voice {
+		const float* Samples;
+		size_t		 Length, Position; // in samples, both channels counted
+		bool		 Loop, Active;
+	};
+	std::vector<float>	 sounds[AUDIO_COUNT];  // interleaved stereo at MIXER_SAMPLE_RATE, at the sound's volume
+	typedef SpscRing<Command, MIXER_COMMAND_QUEUE_SIZE> CommandRing;
+	// the device is created with new, which before C++17 ignores the ring's alignment, so the ring is
+	// placed by hand in memory of its own
+	std::vector<unsigned char> commandMemory;
+	CommandRing*		 commands;
+	std::atomic<bool>	 busy[MIXER_VOICES];   // from Play until the mixer has ended the voice
+	std::atomic<bool>	 stopping[MIXER_VOICES]; // released while playing; the mixer ends the voice at its next buffer
+	bool				 held[MIXER_VOICES];   // handed out and not released yet; caller's thread only
+	unsigned int		 generations[MIXER_VOICES]; // tell apart handles to a reused slot; caller's thread only
+	// the mixer's own state, touched by the mixer thread only (or by Render)
+	Voice				 voices[MIXER_VOICES];
+	std::vector<float>	 mixed;
+	std::vector<short>	 pcm;
+	std::FILE*			 wav;
+	unsigned long long	 framesWritten;
+	std::thread			 mixer;
+	std::atomic<bool>	 running;
+	mutable std::mutex	 statsLock;
+	TimingStats			 mixTimes;	// CPU time per buffer
+	unsigned int		 underruns;
+	void run();
+	void mixBuffer(); // takes the queued commands and mixes the next buffer into pcm
+	void writeWavHeader();
+	static bool loadWav(const char* file, float volume, std::vector<float>& samples);
+};
+
+#endif
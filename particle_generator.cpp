@@ -1,7 +1,9 @@
 #include "particle_generator.h"
 
-ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount)
-	: shader(shader), texture(texture), amount(amount)
+#include <cmath>
+
+ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount, StreamBuffer& stream, JobSystem& jobs)
+	: shader(shader), texture(texture), amount(amount), stream(stream), jobs(jobs)
 {
 	this->init();
 }
@@ -14,40 +16,84 @@ void ParticleGenerator::Update(float dt, GameObject& object, unsigned int newPar
 		int unusedParticle = this->firstUnusedParticle();
 		this->respawnParticle(this->particles[unusedParticle], object, offset);
 	}
-	//update all particles
-	for (unsigned int i = 0; i < this->amount; ++i)
+	//update all particles, every one independently of the others
+	this->jobs.ParallelFor(this->amount, PARTICLE_JOB_CHUNK, [this, dt](unsigned int begin, unsigned int end)
 	{
-		Particle& p = this->particles[i];
-		p.Life -= dt;//reduce life
-		if (p.Life > 0.0f)
+		for (unsigned int i = begin; i < end; ++i)
 		{
-			//particle is alive, thus update
-			p.Position -= p.Velocity * dt;
-			p.Color.a -= dt * 2.5f;
+			Particle& p = this->particles[i];
+			p.Life -= dt;//reduce life
+			if (p.Life > 0.0f)
+			{
+				//particle is alive, thus update
+				p.Position -= p.Velocity * dt;
+				p.Color.a -= dt * 2.5f;
+			}
 		}
+	});
+}
 
+void ParticleGenerator::Burst(glm::vec2 position, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		Particle& particle = this->particles[this->firstUnusedParticle()];
+		float angle = (rand() % 360) * 3.14159265f / 180.0f;
+		float speed = 40.0f + rand() % 80;
+		float rColor = 0.5f + ((rand() % 100) / 100.0f);
+		particle.Position = position;
+		particle.Velocity = glm::vec2(std::cos(angle), std::sin(angle)) * speed;
+		particle.Color = glm::vec4(rColor, rColor, rColor, 1.0f);
+		particle.Life = 1.0f;
 	}
 }
 
-//render all particles
-void ParticleGenerator::Draw()
+void ParticleGenerator::Snapshot(std::vector<Particle>& live) const
 {
-	// use additive blending to give it a glow effect
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-	this->shader.Use();
-	for (Particle particle : this->particles) {
+	live.clear();
+	for (const Particle& particle : this->particles)
 		if (particle.Life > 0.0f)
+			live.push_back(particle);
+}
+
+//render all particles
+void ParticleGenerator::Draw(RenderQueue& queue, const std::vector<Particle>& live)
+{
+	// pack the particles as <vec2 offset, vec4 color> instances; each chunk writes its own range
+	unsigned int alive = static_cast<unsigned int>(live.size());
+	if (alive == 0)
+		return;
+	StreamAllocation allocation = this->stream.Allocate(alive * 6 * sizeof(float), sizeof(float));
+	if (allocation.Data == nullptr)
+		return;
+	float* instances = static_cast<float*>(allocation.Data);
+	this->jobs.ParallelFor(alive, PARTICLE_JOB_CHUNK, [&live, instances](unsigned int begin, unsigned int end)
+	{
+		float* instance = instances + begin * 6;
+		for (unsigned int i = begin; i < end; ++i, instance += 6)
 		{
-			this->shader.SetVector2f("offset", particle.Position);
-			this->shader.SetVector4f("color", particle.Color);
-			this->texture.Bind();
-			glBindVertexArray(this->VAO);
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-			glBindVertexArray(0);
+			const Particle& particle = live[i];
+			instance[0] = particle.Position.x;
+			instance[1] = particle.Position.y;
+			instance[2] = particle.Color.r;
+			instance[3] = particle.Color.g;
+			instance[4] = particle.Color.b;
+			instance[5] = particle.Color.a;
 		}
-	}
-	// dont forget to reset to default blending mode
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	});
+	this->stream.Commit();
+
+	// GL 3.3 has no base instance, so the instance attributes are pointed at this frame's data;
+	// the VAO is only drawn from by this one command per frame, so this can happen before the queue is flushed
+	glBindVertexArray(this->VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, this->stream.ID);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)allocation.Offset);
+	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(allocation.Offset + 2 * sizeof(float)));
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	// use additive blending to give it a glow effect
+	RenderCommand command = { this->shader.ID, this->VAO, this->texture.ID, 0, 6, static_cast<int>(alive), -1, glm::vec3(1.0f) };
+	queue.Push(LAYER_PARTICLES, BLEND_ADDITIVE, command);
 }
 
 void ParticleGenerator::init()
@@ -73,7 +119,16 @@ void ParticleGenerator::init()
 	//set mesh attributes
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+	//per-instance attributes live in the stream buffer; Draw sets their offsets
+	glBindBuffer(GL_ARRAY_BUFFER, this->stream.ID);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(2 * sizeof(float)));
+	glVertexAttribDivisor(2, 1);
 	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
 	// create this.amount default particle instances
 	for (unsigned int i = 0; i < this->amount; ++i) {
@@ -11,6 +11,12 @@
 #include "shader.h"
 #include "texture.h"
 #include "game_object.h"
+#include "stream_buffer.h"
+#include "render_queue.h"
+#include "job_system.h"
+
+// particles per job when integrating or packing them; fewer are handled on the calling thread
+const unsigned int PARTICLE_JOB_CHUNK = 2048;
 
 // represents a signle particle and its state
 struct Particle {
@@ -27,14 +33,18 @@ struct Particle {
 class ParticleGenerator
 {
 public:
-	ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount);
+	ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount, StreamBuffer& stream, JobSystem& jobs);
 	void Update(float dt, GameObject& object, unsigned int newParticles, glm::vec2 offset = glm::vec2(0.0f, 0.0f)); // updates all particles
-	void Draw(); // render all particles
+	void Burst(glm::vec2 position, unsigned int count); // spawns particles flying apart from a point
+	void Snapshot(std::vector<Particle>& live) const; // copies the live particles, so they can be drawn while Update runs
+	void Draw(RenderQueue& queue, const std::vector<Particle>& live); // queues live particles as one instanced, additively blended draw
 private:
 	std::vector<Particle> particles;
 	unsigned int amount;
 	Shader shader;
 	Texture2D texture;
+	StreamBuffer& stream; // per-particle offset and color are streamed each draw
+	JobSystem&	  jobs;
 	unsigned int VAO;
 	void init(); // initializes buffer and vertex attributes
 	unsigned int firstUnusedParticle(); // returns the first Particle index that's currently unused e.g. Life <= 0.0f or 0 if no particle is currently inactive
@@ -1,31 +1,128 @@
+
 #include "postprocessor.h"
 
+#include <algorithm>
 #include <iostream>
+#include <string>
+
+#include "resource_manager.h"
+
+const char* AntiAliasingName(AntiAliasing mode)
+{
+    static const char* names[AA_MODE_COUNT] = { "off", "msaa 2x", "msaa 4x", "msaa 8x", "fxaa" };
+    return names[mode];
+}
+
+unsigned int AntiAliasingSamples(AntiAliasing mode)
+{
+    static const unsigned int samples[AA_MODE_COUNT] = { 0, 2, 4, 8, 0 };
+    return samples[mode];
+}
+
+PostProcessor::PostProcessor(Shader shader, unsigned int width, unsigned int height, AntiAliasing antiAliasing)
+    : PostProcessingShader(shader), Texture(), Width(width), Height(height), Confuse(false), Chaos(false), Shake(false),
+    MSFBO(0), FBO(0), RBO(0), antiAliasing(antiAliasing),
+    renderScale(1.0f), sceneWidth(width), sceneHeight(height), samples(0), screenSamples(0), offscreen(false), direct(false)
+{
+    // a window with the same sample count as the scene lets effect-free frames render straight to the screen
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glGetIntegerv(GL_SAMPLES, &this->screenSamples);
+    this->initFramebuffers();
+    // initialize render data and build one shader variant per effect combination;
+    // the shader we were given is the variant without effects
+    this->initRenderData();
+    for (unsigned int effects = 0; effects < EFFECT_VARIANT_COUNT; ++effects)
+    {
+        if ((effects & EFFECT_CHAOS) && (effects & EFFECT_CONFUSE))
+            continue; // chaos wins, never selected
+        if (effects == 0)
+            this->variants[effects] = this->PostProcessingShader;
+        else
+        {
+            std::string defines, name;
+            if (effects & EFFECT_CHAOS)   { defines += "#define CHAOS\n";   name += "chaos "; }
+            if (effects & EFFECT_CONFUSE) { defines += "#define CONFUSE\n"; name += "confuse "; }
+            if (effects & EFFECT_SHAKE)   { defines += "#define SHAKE\n";   name += "shake "; }
+            if (effects & EFFECT_FXAA)    { defines += "#define FXAA\n";    name += "fxaa "; }
+            name.pop_back();
+            this->variants[effects] = ResourceManager::LoadShaderVariant(SHADER_POSTPROCESSING, name.c_str(), defines);
+        }
+        this->initVariant(effects);
+    }
+}
+
+PostProcessor::~PostProcessor()
+{
+    this->deleteFramebuffers();
+}
+
+void PostProcessor::SetAntiAliasing(AntiAliasing mode)
+{
+    if (mode == this->antiAliasing)
+        return;
+    this->antiAliasing = mode;
+    this->deleteFramebuffers();
+    this->initFramebuffers();
+}
+
+void PostProcessor::SetRenderScale(float scale)
+{
+    this->renderScale = std::max(MIN_RENDER_SCALE, std::min(scale, 1.0f));
+    unsigned int width = std::max(1u, static_cast<unsigned int>(this->Width * this->renderScale + 0.5f));
+    unsigned int height = std::max(1u, static_cast<unsigned int>(this->Height * this->renderScale + 0.5f));
+    if (width == this->sceneWidth && height == this->sceneHeight)
+        return;
+    this->sceneWidth = width;
+    this->sceneHeight = height;
+    this->deleteFramebuffers();
+    this->initFramebuffers();
+    this->updateTexelSize();
+}
 
-PostProcessor::PostProcessor(Shader shader, unsigned int width, unsigned int height)
-    : PostProcessingShader(shader), Texture(), Width(width), Height(height), Confuse(false), Chaos(false), Shake(false)
+void PostProcessor::initFramebuffers()
 {
-    // initialize renderbuffer/framebuffer object
-    glGenFramebuffers(1, &this->MSFBO);
+    int maxSamples = 0;
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+    this->samples = std::min(AntiAliasingSamples(this->antiAliasing), static_cast<unsigned int>(maxSamples));
     glGenFramebuffers(1, &this->FBO);
-    glGenRenderbuffers(1, &this->RBO);
-    // initialize renderbuffer storage with a multisampled color buffer (don't need a depth/stencil buffer)
-    glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
-    glBindRenderbuffer(GL_RENDERBUFFER, this->RBO);
-    glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_RGB, width, height); // allocate storage for render buffer object
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->RBO); // attach MS render buffer object to framebuffer
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "ERROR::POSTPROCESSOR: Failed to initialize MSFBO" << std::endl;
+    if (this->samples > 0)
+    {
+        // initialize renderbuffer storage with a multisampled color buffer (don't need a depth/stencil buffer)
+        glGenFramebuffers(1, &this->MSFBO);
+        glGenRenderbuffers(1, &this->RBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
+        glBindRenderbuffer(GL_RENDERBUFFER, this->RBO);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, this->samples, GL_RGBA8, this->sceneWidth, this->sceneHeight); // allocate storage for render buffer object (same format as the window, so it can be resolved into it)
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->RBO); // attach MS render buffer object to framebuffer
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::POSTPROCESSOR: Failed to initialize MSFBO" << std::endl;
+    }
     // also initialize the FBO/texture to blit multisampled color-buffer to; used for shader operations (for postprocessing effects)
+    // without MSAA the scene is rendered into it directly
     glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
-    this->Texture.Generate(width, height, NULL);
+    this->Texture.Internal_Format = GL_RGBA8;
+    this->Texture.Image_Format = GL_RGBA;
+    this->Texture.Wrap_S = this->Texture.Wrap_T = GL_CLAMP_TO_EDGE; // the FXAA taps must not wrap around the screen edges
+    this->Texture.Generate(this->sceneWidth, this->sceneHeight, NULL); // linear filtering upscales a reduced render scale
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->Texture.ID, 0); // attach texture to framebuffer as its color attachment
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         std::cout << "ERROR::POSTPROCESSOR: Failed to initialize FBO" << std::endl;
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    // initialize render data and uniforms
-    this->initRenderData();
-    this->PostProcessingShader.SetInteger("scene", 0, true);
+}
+
+void PostProcessor::deleteFramebuffers()
+{
+    glDeleteFramebuffers(1, &this->MSFBO);
+    glDeleteFramebuffers(1, &this->FBO);
+    glDeleteRenderbuffers(1, &this->RBO);
+    this->MSFBO = this->FBO = this->RBO = 0;
+}
+
+void PostProcessor::initVariant(unsigned int effects)
+{
+    Shader& shader = this->variants[effects];
+    shader.SetInteger("scene", 0, true);
+    shader.SetVector2f("texelSize", 1.0f / this->sceneWidth, 1.0f / this->sceneHeight);
     float offset = 1.0f / 300.0f;
     float offsets[9][2] = {
         { -offset,  offset  },  // top-left
@@ -38,50 +135,106 @@ PostProcessor::PostProcessor(Shader shader, unsigned int width, unsigned int hei
         {  0.0f,   -offset  },  // bottom-center
         {  offset, -offset  }   // bottom-right    
     };
-    glUniform2fv(glGetUniformLocation(this->PostProcessingShader.ID, "offsets"), 9, (float*)offsets);
+    glUniform2fv(glGetUniformLocation(shader.ID, "offsets"), 9, (float*)offsets);
     int edge_kernel[9] = {
         -1, -1, -1,
         -1,  8, -1,
         -1, -1, -1
     };
-    glUniform1iv(glGetUniformLocation(this->PostProcessingShader.ID, "edge_kernel"), 9, edge_kernel);
+    glUniform1iv(glGetUniformLocation(shader.ID, "edge_kernel"), 9, edge_kernel);
     float blur_kernel[9] = {
         1.0f / 16.0f, 2.0f / 16.0f, 1.0f / 16.0f,
         2.0f / 16.0f, 4.0f / 16.0f, 2.0f / 16.0f,
         1.0f / 16.0f, 2.0f / 16.0f, 1.0f / 16.0f
     };
-    glUniform1fv(glGetUniformLocation(this->PostProcessingShader.ID, "blur_kernel"), 9, blur_kernel);
+    glUniform1fv(glGetUniformLocation(shader.ID, "blur_kernel"), 9, blur_kernel);
+}
+
+void PostProcessor::updateTexelSize()
+{
+    for (unsigned int effects = EFFECT_FXAA; effects < EFFECT_VARIANT_COUNT; ++effects)
+        if (this->variants[effects].ID != 0)
+            this->variants[effects].SetVector2f("texelSize", 1.0f / this->sceneWidth, 1.0f / this->sceneHeight, true);
+}
+
+unsigned int PostProcessor::activeVariant() const
+{
+    unsigned int effects = this->antiAliasing == AA_FXAA ? EFFECT_FXAA : 0;
+    if (this->Chaos)
+        effects |= EFFECT_CHAOS;
+    else if (this->Confuse)
+        effects |= EFFECT_CONFUSE;
+    if (this->Shake)
+        effects |= EFFECT_SHAKE;
+    return effects;
 }
 
 void PostProcessor::BeginRender()
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, this->MSFBO);
+    this->frameTimers[this->antiAliasing].Begin();
+    // without effects the scene only needs the offscreen buffer if the window can't do the anti-aliasing itself;
+    // a multisampled window can't be blitted into from a buffer with another sample count or size, so those take the quad pass
+    bool scaled = this->sceneWidth != this->Width || this->sceneHeight != this->Height;
+    this->direct = this->activeVariant() == 0 && !scaled && this->screenSamples == static_cast<int>(this->samples);
+    this->offscreen = !this->direct && (this->activeVariant() != 0 || scaled || this->screenSamples > 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, this->direct ? 0 : (this->samples > 0 ? this->MSFBO : this->FBO));
+    if (!this->direct)
+        glViewport(0, 0, this->sceneWidth, this->sceneHeight);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 }
 void PostProcessor::EndRender()
 {
-    // now resolve multisampled color-buffer into intermediate FBO to store to texture
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, this->MSFBO);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->FBO);
-    glBlitFramebuffer(0, 0, this->Width, this->Height, 0, 0, this->Width, this->Height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    if (!this->direct && (this->samples > 0 || !this->offscreen))
+    {
+        // now resolve multisampled color-buffer into intermediate FBO to store to texture,
+        // or copy the scene directly into the window when there is no effect to apply
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, this->samples > 0 ? this->MSFBO : this->FBO);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->offscreen ? this->FBO : 0);
+        glBlitFramebuffer(0, 0, this->sceneWidth, this->sceneHeight, 0, 0, this->sceneWidth, this->sceneHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
     glBindFramebuffer(GL_FRAMEBUFFER, 0); // binds both READ and WRITE framebuffer to default framebuffer
+    glViewport(0, 0, this->Width, this->Height); // the final pass and everything after it (text) is drawn at native resolution
+    if (!this->offscreen)
+        this->frameTimers[this->antiAliasing].End(); // no full-screen pass follows
 }
 
-void PostProcessor::Render(float time)
+void PostProcessor::Render()
 {
-    // set uniforms/options
-    this->PostProcessingShader.Use();
-    this->PostProcessingShader.SetFloat("time", time);
-    this->PostProcessingShader.SetInteger("confuse", this->Confuse);
-    this->PostProcessingShader.SetInteger("chaos", this->Chaos);
-    this->PostProcessingShader.SetInteger("shake", this->Shake);
+    if (!this->offscreen)
+        return; // the scene is already on screen
+
+    // the effects are baked into the variant and the time-based ones read the Globals block, so there is nothing to set
+    unsigned int effects = this->activeVariant();
+    this->variants[effects].Use();
     // render textured quad
+    this->variantTimers[effects].Begin();
     glActiveTexture(GL_TEXTURE0);
     this->Texture.Bind();
     glBindVertexArray(this->VAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
     glBindVertexArray(0);
+    this->variantTimers[effects].End();
+    this->frameTimers[this->antiAliasing].End();
+}
+
+void PostProcessor::PrintTimings() const
+{
+    std::cout << "POSTPROCESSOR: scene GPU time per anti-aliasing mode" << std::endl;
+    for (unsigned int mode = 0; mode < AA_MODE_COUNT; ++mode)
+        if (this->frameTimers[mode].Samples > 0)
+            std::cout << "  " << AntiAliasingName(static_cast<AntiAliasing>(mode)) << " " << this->frameTimers[mode].AverageMs()
+                << " ms avg over " << this->frameTimers[mode].Samples << " frames" << std::endl;
+    std::cout << "POSTPROCESSOR: full-screen pass GPU time per variant" << std::endl;
+    for (unsigned int effects = 0; effects < EFFECT_VARIANT_COUNT; ++effects)
+    {
+        const GpuTimer& timer = this->variantTimers[effects];
+        if (timer.Samples == 0)
+            continue;
+        std::cout << "  " << (effects & EFFECT_CHAOS ? "chaos " : "") << (effects & EFFECT_CONFUSE ? "confuse " : "")
+            << (effects & EFFECT_SHAKE ? "shake " : "") << (effects & EFFECT_FXAA ? "fxaa " : "") << (effects == 0 ? "none " : "")
+            << timer.AverageMs() << " ms avg over " << timer.Samples << " frames" << std::endl;
+    }
 }
 
 void PostProcessor::initRenderData()
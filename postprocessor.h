@@ -9,12 +9,43 @@
 #include "texture.h"
 #include "sprite_renderer.h"
 #include "shader.h"
+#include "gpu_timer.h"
+
+// bits of a post-processing shader variant; chaos overrides confuse so that pair has no variant of its own
+enum PostProcessEffect {
+    EFFECT_CHAOS = 1,
+    EFFECT_CONFUSE = 2,
+    EFFECT_SHAKE = 4,
+    EFFECT_FXAA = 8,
+    EFFECT_VARIANT_COUNT = 16
+};
+
+const float MIN_RENDER_SCALE = 0.5f;
+
+// how the scene is anti-aliased
+enum AntiAliasing {
+    AA_OFF,
+    AA_MSAA_2X,
+    AA_MSAA_4X,
+    AA_MSAA_8X,
+    AA_FXAA, // single-sample scene, FXAA applied in the post-processing pass
+    AA_MODE_COUNT
+};
+
+const char* AntiAliasingName(AntiAliasing mode);
+unsigned int AntiAliasingSamples(AntiAliasing mode); // MSAA samples of the scene for a mode (0 = single-sampled)
 
 
 // PostProcessor hosts all PostProcessing effects for the Breakout
 // Game. It renders the game on a textured quad after which one can
 // enable specific effects by enabling either the Confuse, Chaos or 
-// Shake boolean. 
+// Shake boolean. Every combination of effects is compiled into its own
+// shader variant at load time. While no effect (and no FXAA) is active
+// the offscreen chain is skipped and the scene goes straight to the
+// window's framebuffer. The anti-aliasing mode can be changed at any
+// time; the framebuffers are rebuilt to match. The offscreen targets can
+// be rendered at a fraction of the window size (RenderScale) and are
+// upscaled bilinearly by the final pass.
 // It is required to call BeginRender() before rendering the game
 // and EndRender() after rendering the game for the class to work.
 class PostProcessor
@@ -25,17 +56,39 @@ public:
 	Texture2D Texture;
 	unsigned int Width, Height;
 	bool Confuse, Chaos, Shake; // options
-	PostProcessor(Shader shader, unsigned int width, unsigned int height);
+	PostProcessor(Shader shader, unsigned int width, unsigned int height, AntiAliasing antiAliasing = AA_MSAA_4X);
+	~PostProcessor();
 	void BeginRender();//prepares the postprocessor's framebuffer operations before rendering the game
 	void EndRender();//should be called after rendering the game, so it stores all the rendered data into a texture object
-	void Render(float time); //renders the PostProcessor texture quad ( as a screen-encompassing large sprite)
+	void Render(); //renders the PostProcessor texture quad ( as a screen-encompassing large sprite); time comes from the Globals block
+	void SetAntiAliasing(AntiAliasing mode); //rebuilds the framebuffers for the new mode
+	AntiAliasing GetAntiAliasing() const { return this->antiAliasing; }
+	void SetRenderScale(float scale); //resizes the offscreen targets to scale * window size, clamped to [MIN_RENDER_SCALE, 1]
+	float GetRenderScale() const { return this->renderScale; }
+	const GpuTimer& FrameTimer(AntiAliasing mode) const { return this->frameTimers[mode]; } //GPU time from BeginRender to the end of Render
+	void PrintTimings() const; //prints the measured GPU time per anti-aliasing mode and per variant used
 private:
 	//render state
 	unsigned int MSFBO, FBO; // MSFBO = Multisampled FBO. FBO is regular, used for blitting MS color-buffer to texture
 	unsigned int RBO; // RBO is used for multisampled color buffer;
 	unsigned int VAO;
+	AntiAliasing antiAliasing;
+	float		 renderScale;
+	unsigned int sceneWidth, sceneHeight; // size of the offscreen targets
+	unsigned int samples;		// MSAA samples of the scene, 0 renders the scene single-sampled into FBO
+	int			 screenSamples; // samples of the default framebuffer
+	bool		 offscreen;		// this frame renders through the effect chain
+	bool		 direct;		// this frame renders straight into the window
+	//effect variants, indexed by PostProcessEffect bits
+	Shader		 variants[EFFECT_VARIANT_COUNT];
+	GpuTimer	 variantTimers[EFFECT_VARIANT_COUNT];
+	GpuTimer	 frameTimers[AA_MODE_COUNT];
+	void initFramebuffers();
+	void deleteFramebuffers();
 	void initRenderData(); //initialize quad for rendering postprocessing texture
+	void initVariant(unsigned int effects); //sets the constant uniforms of a variant
+	void updateTexelSize(); //FXAA samples its neighbours one scene texel apart
+	unsigned int activeVariant() const;
 };
 
 #endif
-
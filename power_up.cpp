@@ -1 +1,11 @@
+
 #include "power_up.h"
+
+const PowerUpInfo PowerUpTable[POWERUP_TYPE_COUNT] = {
+	{ glm::vec3(0.5f, 0.5f, 1.0f),	 0.0f, 75, TEXTURE_POWERUP_SPEED },
+	{ glm::vec3(1.0f, 0.5f, 1.0f),	20.0f, 75, TEXTURE_POWERUP_STICKY },
+	{ glm::vec3(0.5f, 1.0f, 0.5f),	10.0f, 75, TEXTURE_POWERUP_PASSTHROUGH },
+	{ glm::vec3(1.0f, 0.6f, 0.4f),	 0.0f, 75, TEXTURE_POWERUP_INCREASE },
+	{ glm::vec3(1.0f, 0.3f, 0.3f),	15.0f, 15, TEXTURE_POWERUP_CONFUSE }, // negative powerups should spawn more often
+	{ glm::vec3(0.9f, 0.25f, 0.25f), 15.0f, 15, TEXTURE_POWERUP_CHAOS }
+};
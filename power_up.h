@@ -2,33 +2,51 @@
 #ifndef POWER_UP_H
 #define POWER_UP_H
 
-#include <string>
-
 #include <glm/glm.hpp>
 #include <glad/glad.h>
 
 #include "game_object.h"
+#include "resource_manager.h"
 
 const glm::vec2 SIZE(60.0f, 20.0f); // The size of a Power Up block
 const glm::vec2 VELOCITY(0.0f, 150.0f); // Velocity a PowerUp block when spawned
 
+// Every kind of power up, in the order they are rolled for when a brick is destroyed
+enum PowerUpType {
+	POWERUP_SPEED,
+	POWERUP_STICKY,
+	POWERUP_PASS_THROUGH,
+	POWERUP_PAD_SIZE_INCREASE,
+	POWERUP_CONFUSE,
+	POWERUP_CHAOS,
+	POWERUP_TYPE_COUNT
+};
+
+// Static description of a power up type
+struct PowerUpInfo {
+	glm::vec3	 Color;
+	float		 Duration;	  // seconds the effect lasts once activated (0 = permanent)
+	unsigned int SpawnChance; // spawns with a 1 in SpawnChance chance per destroyed brick
+	TextureID	 Sprite;
+};
+
+extern const PowerUpInfo PowerUpTable[POWERUP_TYPE_COUNT];
+
 /// PowerUp inherits its state and rendering functions from
 /// GameObject but also holds extra information to state its
 /// active duration and whenever it is activated or not.
-/// The type of power up is stored as a string.
+/// The look and duration of each type come from PowerUpTable.
 class PowerUp : public GameObject
 {
 public:
 	//powerup state
-	std::string Type;
+	PowerUpType Type;
 	float		Duration;
 	bool		Activated;
 	//constructor
-	PowerUp(std::string type, glm::vec3 color, float duration,
-		glm::vec2 position, Texture2D texture)
-		: GameObject(position, SIZE, texture, color, VELOCITY),
-		Type(type), Duration(duration), Activated()
+	PowerUp(PowerUpType type, glm::vec2 position)
+		: GameObject(position, SIZE, ResourceManager::GetTexture(PowerUpTable[type].Sprite), PowerUpTable[type].Color, VELOCITY),
+		Type(type), Duration(PowerUpTable[type].Duration), Activated()
 	{}
 };
 #endif 
-
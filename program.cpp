@@ -5,7 +5,13 @@
 
 #include "Game.h"
 #include "resource_manager.h"
+#include "gl_extensions.h"
+#include "benchmark.h"
+#include "soak_test.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -17,8 +23,95 @@ const unsigned int SCREEN_HEIGHT = 600;
 
 Game Breakout(SCREEN_WIDTH, SCREEN_HEIGHT);
 
+// command line: --aa=off|msaa2|msaa4|msaa8|fxaa picks the starting anti-aliasing mode,
+// --render-scale=<0.5..1> renders the scene at a fixed fraction of the window size,
+// --target-fps=<fps> lets dynamic resolution hold that frame rate instead (0 turns it off),
+// --tick-rate=<hz> sets how often the simulation steps,
+// --benchmark[=frames] measures every mode and exits,
+// --batch-benchmark[=games] measures headless game ticks per second and exits,
+// --soak[=runs] lets the autoplayer play every level that many times headless and exits,
+// --autoplay lets the autoplayer steer the paddle while playing,
+// --audio=irrklang|mixer|null picks the audio device, --audio-wav=<file> makes the mixer record to a WAV file,
+// --audio-benchmark[=seconds] mixes that much audio as fast as it goes, into --audio-wav if given, and exits
+bool parseAntiAliasing(const char* value, AntiAliasing& mode)
+{
+	static const char* options[AA_MODE_COUNT] = { "off", "msaa2", "msaa4", "msaa8", "fxaa" };
+	for (unsigned int i = 0; i < AA_MODE_COUNT; ++i)
+		if (strcmp(value, options[i]) == 0)
+		{
+			mode = static_cast<AntiAliasing>(i);
+			return true;
+		}
+	return false;
+}
+
+bool parseAudioBackend(const char* value, AudioBackend& backend)
+{
+	for (unsigned int i = 0; i < AUDIO_BACKEND_COUNT; ++i)
+		if (strcmp(value, AudioBackendName(static_cast<AudioBackend>(i))) == 0)
+		{
+			backend = static_cast<AudioBackend>(i);
+			return true;
+		}
+	return false;
+}
+
 int main(int arc, char *argv[])
 {
+	unsigned int benchmarkFrames = 0;
+	unsigned int batchGames = 0;
+	unsigned int soakRuns = 0;
+	unsigned int audioSeconds = 0;
+	for (int i = 1; i < arc; ++i)
+	{
+		if (strncmp(argv[i], "--aa=", 5) == 0)
+		{
+			if (!parseAntiAliasing(argv[i] + 5, Breakout.AntiAliasingMode))
+				std::cout << "ERROR::MAIN: Unknown anti-aliasing mode " << argv[i] + 5 << std::endl;
+		}
+		else if (strncmp(argv[i], "--render-scale=", 15) == 0)
+		{
+			Breakout.RenderScale = static_cast<float>(atof(argv[i] + 15));
+			Breakout.TargetFps = 0.0f;
+		}
+		else if (strncmp(argv[i], "--target-fps=", 13) == 0)
+			Breakout.TargetFps = static_cast<float>(atof(argv[i] + 13));
+		else if (strncmp(argv[i], "--tick-rate=", 12) == 0)
+			Breakout.TickRate = std::max(1.0f, static_cast<float>(atof(argv[i] + 12)));
+		else if (strcmp(argv[i], "--benchmark") == 0)
+			benchmarkFrames = 300;
+		else if (strncmp(argv[i], "--benchmark=", 12) == 0)
+			benchmarkFrames = std::max(1, atoi(argv[i] + 12));
+		else if (strcmp(argv[i], "--batch-benchmark") == 0)
+			batchGames = 1024;
+		else if (strncmp(argv[i], "--batch-benchmark=", 18) == 0)
+			batchGames = std::max(1, atoi(argv[i] + 18));
+		else if (strcmp(argv[i], "--soak") == 0)
+			soakRuns = 1000;
+		else if (strncmp(argv[i], "--soak=", 7) == 0)
+			soakRuns = std::max(1, atoi(argv[i] + 7));
+		else if (strcmp(argv[i], "--autoplay") == 0)
+			Breakout.Autoplay = true;
+		else if (strncmp(argv[i], "--audio=", 8) == 0)
+		{
+			if (!parseAudioBackend(argv[i] + 8, Breakout.AudioMode))
+				std::cout << "ERROR::MAIN: Unknown audio device " << argv[i] + 8 << std::endl;
+		}
+		else if (strncmp(argv[i], "--audio-wav=", 12) == 0)
+			Breakout.AudioFile = argv[i] + 12;
+		else if (strcmp(argv[i], "--audio-benchmark") == 0)
+			audioSeconds = 60;
+		else if (strncmp(argv[i], "--audio-benchmark=", 18) == 0)
+			audioSeconds = std::max(1, atoi(argv[i] + 18));
+	}
+	// the batch, soak and audio runs need no window or GL
+	if (audioSeconds > 0)
+		return RunAudioBenchmark(audioSeconds, Breakout.AudioFile);
+	if (batchGames > 0)
+		return RunBatchBenchmark(batchGames, SCREEN_WIDTH, SCREEN_HEIGHT);
+	if (soakRuns > 0)
+		return RunSoakTest(soakRuns, SCREEN_WIDTH, SCREEN_HEIGHT, Breakout.TickRate);
+
 	// glfw: initialize and configure
 	// ------------------------------
 	glfwInit();
@@ -30,6 +123,7 @@ int main(int arc, char *argv[])
 	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
 	glfwWindowHint(GLFW_RESIZABLE, false);
+	glfwWindowHint(GLFW_SAMPLES, AntiAliasingSamples(Breakout.AntiAliasingMode)); // lets the post processor render effect-free frames straight to the window
 
 	// glfw window creation
 	// --------------------
@@ -50,6 +144,7 @@ int main(int arc, char *argv[])
 		std::cout << "Failed to initialize GLAD" << std::endl;
 		return -1;
 	}
+	GLExtensions::Load((GLADloadproc)glfwGetProcAddress);
 	glfwSetKeyCallback(window, key_callback);
 	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
@@ -57,26 +152,53 @@ int main(int arc, char *argv[])
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	Breakout.Init();
+	if (!Breakout.Init())
+	{
+		glfwTerminate();
+		return -1;
+	}
+
+	if (benchmarkFrames > 0)
+	{
+		glfwSwapInterval(0);
+		int result = RunBenchmark(Breakout, window, benchmarkFrames);
+		ResourceManager::Clear();
+		glfwTerminate();
+		return result;
+	}
 
 	float deltaTime = 0.0f;
 	float lastFrame = 0.0f;
 
-	// render loop
-	// -----------
-	while (!glfwWindowShouldClose(window))
+	// loading screen: textures are uploaded by Update, so it runs on this thread until they are in
+	// --------------------------------------------------------------------------------------------
+	while (!glfwWindowShouldClose(window) && Breakout.Loading())
 	{
-		// input
-		// -----
 		float currentFrame = (float)glfwGetTime();
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
 		glfwPollEvents();
 
-		Breakout.ProcessInput(deltaTime);
-
+		Breakout.ProcessInput(deltaTime); // keeps the input queue drained
 		Breakout.Update(deltaTime);
 
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		Breakout.Render();
+		glfwSwapBuffers(window);
+	}
+
+	// render loop: from here on the game steps on its own thread, this one only draws its snapshots
+	// -----------------------------------------------------------------------------------------------
+	// closing the window during the loading screen ends it early; the simulation must not upload textures
+	if (!Breakout.Loading())
+		Breakout.StartSimulation();
+	while (!glfwWindowShouldClose(window))
+	{
+		// input
+		// -----
+		glfwPollEvents();
+
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
 		Breakout.Render();
@@ -85,6 +207,7 @@ int main(int arc, char *argv[])
 		// -------------------------------------------------------------------------------
 		glfwSwapBuffers(window);
 	}
+	Breakout.StopSimulation();
 
 	// glfw: terminate, clearing all previously allocated GLFW resources.
 	// ------------------------------------------------------------------
@@ -100,14 +223,9 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 {
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, true);
-	if (key >= 0 && key < 1024)
-	{
-		if (action == GLFW_PRESS)
-			Breakout.Keys[key] = true;
-		else if (action == GLFW_RELEASE)
-			Breakout.Keys[key] = false;
-			Breakout.KeysProcessed[key] = false;
-	}
+	// the simulation picks the event up at its next step; key repeats carry no new state
+	if (action == GLFW_PRESS || action == GLFW_RELEASE)
+		Breakout.KeyEvent(key, action == GLFW_PRESS);
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
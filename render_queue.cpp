@@ -0,0 +1,133 @@
+#include "render_queue.h"
+
+#include <iostream>
+
+// bit layout of a sort key, most significant first
+const unsigned int KEY_SEQUENCE_BITS = 22;
+const unsigned int KEY_TEXTURE_BITS = 20;
+const unsigned int KEY_PROGRAM_BITS = 12;
+const unsigned int KEY_BLEND_BITS = 2;
+
+RenderQueue::RenderQueue()
+	: Flushes(0), TotalCommands(0), TotalStateChanges(0)
+{
+}
+
+void RenderQueue::Push(RenderLayer layer, BlendMode blend, const RenderCommand& command)
+{
+	if (command.Count == 0)
+		return;
+	// GL names are small integers, so their low bits identify them well enough for grouping
+	uint64_t key = layer;
+	key = (key << KEY_BLEND_BITS) | blend;
+	key = (key << KEY_PROGRAM_BITS) | (command.Program & ((1u << KEY_PROGRAM_BITS) - 1));
+	key = (key << KEY_TEXTURE_BITS) | (command.Texture & ((1u << KEY_TEXTURE_BITS) - 1));
+	key = (key << KEY_SEQUENCE_BITS) | (this->commands.size() & ((1u << KEY_SEQUENCE_BITS) - 1));
+	this->keys.push_back(key);
+	this->commands.push_back(command);
+}
+
+void RenderQueue::sort()
+{
+	// LSD radix sort on bytes; a byte that is the same in every key is skipped
+	unsigned int count = static_cast<unsigned int>(this->keys.size());
+	this->order.resize(count);
+	this->scratch.resize(count);
+	for (unsigned int i = 0; i < count; ++i)
+		this->order[i] = i;
+	for (unsigned int shift = 0; shift < 64; shift += 8)
+	{
+		unsigned int histogram[256] = { 0 };
+		for (uint64_t key : this->keys)
+			++histogram[(key >> shift) & 0xFF];
+		if (histogram[(this->keys[0] >> shift) & 0xFF] == count)
+			continue;
+		unsigned int offset = 0;
+		for (unsigned int& bucket : histogram)
+		{
+			unsigned int size = bucket;
+			bucket = offset;
+			offset += size;
+		}
+		for (unsigned int index : this->order)
+			this->scratch[histogram[(this->keys[index] >> shift) & 0xFF]++] = index;
+		this->order.swap(this->scratch);
+	}
+}
+
+void RenderQueue::Flush()
+{
+	if (this->commands.empty())
+		return;
+	this->sort();
+	unsigned int program = 0, vao = 0, texture = 0, changes = 0;
+	int blend = -1;
+	glActiveTexture(GL_TEXTURE0);
+	for (unsigned int index : this->order)
+	{
+		const RenderCommand& command = this->commands[index];
+		int commandBlend = static_cast<int>((this->keys[index] >> (KEY_SEQUENCE_BITS + KEY_TEXTURE_BITS + KEY_PROGRAM_BITS)) & ((1u << KEY_BLEND_BITS) - 1));
+		if (commandBlend != blend)
+		{
+			blend = commandBlend;
+			glBlendFunc(GL_SRC_ALPHA, blend == BLEND_ADDITIVE ? GL_ONE : GL_ONE_MINUS_SRC_ALPHA);
+			++changes;
+		}
+		if (command.Program != program)
+		{
+			program = command.Program;
+			glUseProgram(program);
+			++changes;
+		}
+		if (command.VAO != vao)
+		{
+			vao = command.VAO;
+			glBindVertexArray(vao);
+			++changes;
+		}
+		if (command.Texture != texture)
+		{
+			texture = command.Texture;
+			glBindTexture(GL_TEXTURE_2D, texture);
+			++changes;
+		}
+		if (command.ColorLocation != -1)
+			glUniform3f(command.ColorLocation, command.Color.x, command.Color.y, command.Color.z);
+		if (command.Instances > 0)
+			glDrawArraysInstanced(GL_TRIANGLES, command.First, command.Count, command.Instances);
+		else
+			glDrawArrays(GL_TRIANGLES, command.First, command.Count);
+	}
+	// leave the defaults the immediate-mode renderers expect
+	glBindVertexArray(0);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	++this->Flushes;
+	this->TotalCommands += this->commands.size();
+	this->TotalStateChanges += changes;
+	this->commands.clear();
+	this->keys.clear();
+}
+
+void RenderQueue::Execute(const RenderCommand& command)
+{
+	glUseProgram(command.Program);
+	if (command.ColorLocation != -1)
+		glUniform3f(command.ColorLocation, command.Color.x, command.Color.y, command.Color.z);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, command.Texture);
+	glBindVertexArray(command.VAO);
+	if (command.Instances > 0)
+		glDrawArraysInstanced(GL_TRIANGLES, command.First, command.Count, command.Instances);
+	else
+		glDrawArrays(GL_TRIANGLES, command.First, command.Count);
+	glBindVertexArray(0);
+}
+
+void RenderQueue::PrintStats() const
+{
+	if (this->Flushes == 0)
+		return;
+	std::cout << "RENDER_QUEUE: " << static_cast<double>(this->TotalCommands) / this->Flushes << " commands and "
+		<< static_cast<double>(this->TotalStateChanges) / this->Flushes << " state changes per flush over "
+		<< this->Flushes << " flushes" << std::endl;
+}
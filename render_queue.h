@@ -0,0 +1,62 @@
+#pragma once
+
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// draw order of the scene; the most significant part of a sort key
+enum RenderLayer {
+	LAYER_BACKGROUND, // static layer: background and bricks
+	LAYER_PLAYER,
+	LAYER_POWERUPS,
+	LAYER_PARTICLES,
+	LAYER_BALL,
+	LAYER_TEXT
+};
+
+enum BlendMode {
+	BLEND_ALPHA,
+	BLEND_ADDITIVE
+};
+
+// everything needed to issue one draw call; vertex data is already in its buffers
+struct RenderCommand {
+	unsigned int Program;
+	unsigned int VAO;
+	unsigned int Texture;		// bound to texture unit 0
+	int			 First, Count;	// vertex range
+	int			 Instances;		// 0 for a plain draw
+	int			 ColorLocation; // vec3 uniform set before the draw, -1 for none
+	glm::vec3	 Color;
+};
+
+// RenderQueue collects the draw calls of a render pass and submits
+// them together. Every command gets a 64-bit key made of, from most to
+// least significant: layer, blend mode, program, texture and the order
+// it was pushed in. The keys are radix sorted, so layers keep the
+// order they are listed in while draws within a layer are grouped by
+// state, and Flush() only touches GL state that actually changes.
+class RenderQueue
+{
+public:
+	unsigned int Flushes;
+	uint64_t	 TotalCommands, TotalStateChanges;
+	RenderQueue();
+	void Push(RenderLayer layer, BlendMode blend, const RenderCommand& command);
+	void Flush(); // sorts and submits everything pushed since the last flush
+	void PrintStats() const;
+	// issues a single command right away; blending is left as it is
+	static void Execute(const RenderCommand& command);
+private:
+	std::vector<RenderCommand> commands;
+	std::vector<uint64_t>	   keys;
+	std::vector<unsigned int>  order, scratch; // command indices, sorted by key
+	void sort();
+};
+
+#endif
@@ -0,0 +1,46 @@
+#include "resolution_controller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "postprocessor.h"
+
+// the scene is kept between these fractions of the budget; the gap stops the scale from oscillating
+const float RESOLUTION_LOWER_BOUND = 0.70f;
+const float RESOLUTION_UPPER_BOUND = 0.90f;
+const float RESOLUTION_STEP = 0.05f;
+
+ResolutionController::ResolutionController(float targetFps)
+	: Scale(1.0f), TargetMs(targetFps > 0.0f ? 1000.0f / targetFps : 0.0f), lastSamples(0), cooldown(COOLDOWN_SAMPLES), smoothedMs(0.0f)
+{
+}
+
+bool ResolutionController::Update(const GpuTimer& timer)
+{
+	if (this->TargetMs <= 0.0f || timer.Samples == this->lastSamples)
+		return false; // disabled, or no new measurement
+	if (timer.Samples < this->lastSamples)
+	{
+		// timer was reset or swapped for another one, start over
+		this->cooldown = COOLDOWN_SAMPLES;
+		this->smoothedMs = 0.0f;
+	}
+	this->lastSamples = timer.Samples;
+	this->smoothedMs = this->smoothedMs == 0.0f ? timer.LastMs : this->smoothedMs * 0.9f + timer.LastMs * 0.1f;
+	if (--this->cooldown > 0)
+		return false;
+	this->cooldown = COOLDOWN_SAMPLES;
+
+	float lower = this->TargetMs * RESOLUTION_LOWER_BOUND, upper = this->TargetMs * RESOLUTION_UPPER_BOUND;
+	if ((this->smoothedMs <= upper && this->smoothedMs >= lower) || (this->smoothedMs < lower && this->Scale >= 1.0f))
+		return false;
+	// aim for the middle of the band
+	float target = this->Scale * std::sqrt((lower + upper) * 0.5f / std::max(this->smoothedMs, 0.01f));
+	target = std::floor(target / RESOLUTION_STEP + 0.5f) * RESOLUTION_STEP;
+	target = std::max(MIN_RENDER_SCALE, std::min(target, 1.0f));
+	if (target == this->Scale)
+		return false;
+	this->Scale = target;
+	this->smoothedMs = 0.0f; // measurements at the old scale no longer apply
+	return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#ifndef RESOLUTION_CONTROLLER_H
+#define RESOLUTION_CONTROLLER_H
+
+#include "gpu_timer.h"
+
+// ResolutionController picks the render scale of the offscreen scene
+// from its measured GPU time, to keep the scene within a frame budget.
+// Fill cost grows with the square of the scale, so each adjustment
+// moves the scale by the square root of the budget/time ratio. The
+// result is quantized and only changes after a cooldown, so the
+// framebuffers are not rebuilt every frame.
+class ResolutionController
+{
+public:
+	float Scale;		 // current render scale in [MIN_RENDER_SCALE, 1]
+	float TargetMs;		 // GPU time the scene may take per frame, 0 disables the controller
+	ResolutionController(float targetFps = 60.0f);
+	// feeds the latest measurement of the timer; returns true when Scale changed
+	bool Update(const GpuTimer& timer);
+private:
+	static const unsigned int COOLDOWN_SAMPLES = 30; // measurements between adjustments
+	unsigned int lastSamples;
+	unsigned int cooldown;
+	float		 smoothedMs;
+};
+
+#endif
@@ -1,93 +1,188 @@
 #include "resource_manager.h"
 
 #include <iostream>
-#include <sstream>
 #include <fstream>
 
+#include "shader_cache.h"
+#include "timer.h"
+#include "uniform_bindings.h"
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
-std::map<std::string, Texture2D>  ResourceManager::Textures;
-std::map<std::string, Shader>     ResourceManager::Shaders;
+Shader		ResourceManager::Shaders[SHADER_COUNT];
+Texture2D	ResourceManager::Textures[TEXTURE_COUNT];
+bool		ResourceManager::loadFailed = false;
 
-Shader ResourceManager::LoadShader(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile, std::string name)
+bool ResourceManager::LoadShaders()
 {
-	Shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
-	return Shaders[name];
+	loadFailed = false;
+	for (unsigned int i = 0; i < SHADER_COUNT; ++i)
+		LoadShader(static_cast<ShaderID>(i));
+	return !loadFailed;
 }
 
-Shader& ResourceManager::GetShader(std::string name)
+Shader ResourceManager::LoadShader(ShaderID id)
 {
-	return Shaders[name];
+	const ShaderAsset& asset = ShaderManifest[id];
+	if (asset.VertexFile == nullptr || asset.FragmentFile == nullptr)
+	{
+		std::cout << "ERROR::RESOURCE_MANAGER: Shader " << id << " is missing from the asset manifest" << std::endl;
+		loadFailed = true;
+		return Shaders[id];
+	}
+	Shaders[id] = loadShaderFromFile(asset.Name, asset.VertexFile, asset.FragmentFile, asset.GeometryFile);
+	return Shaders[id];
 }
 
-Texture2D ResourceManager::LoadTexture(const char* file, bool alpha, std::string name)
+// inserts the defines right after the #version line, which has to stay first
+static std::string injectDefines(const std::string& source, const std::string& defines)
 {
-	Textures[name] = loadTextureFromFile(file, alpha);
-	return Textures[name];
+	size_t position = 0;
+	if (source.compare(0, 8, "#version") == 0)
+	{
+		position = source.find('\n');
+		position = position == std::string::npos ? source.size() : position + 1;
+	}
+	return source.substr(0, position) + defines + source.substr(position);
 }
 
-Texture2D& ResourceManager::GetTexture(std::string name)
+Shader ResourceManager::LoadShaderVariant(ShaderID id, const char* variantName, const std::string& defines)
 {
-	return Textures[name];
+	const ShaderAsset& asset = ShaderManifest[id];
+	std::string vertexCode, fragmentCode, geometryCode;
+	if (!readFile(asset.VertexFile, vertexCode) || !readFile(asset.FragmentFile, fragmentCode)
+		|| (asset.GeometryFile != nullptr && !readFile(asset.GeometryFile, geometryCode)))
+	{
+		std::cout << "ERROR::SHADER: Failed to read sources of " << asset.Name << std::endl;
+		loadFailed = true;
+		return Shader();
+	}
+	std::string name = std::string(asset.Name) + "[" + variantName + "]";
+	return CompileShader(name.c_str(), injectDefines(vertexCode, defines), injectDefines(fragmentCode, defines),
+		geometryCode.empty() ? geometryCode : injectDefines(geometryCode, defines));
 }
 
-void ResourceManager::Clear()
+void ResourceManager::ReserveTextures()
 {
-	for (auto iter : Shaders)
-		glDeleteProgram(iter.second.ID);
-	for (auto iter : Textures)
-		glDeleteTextures(1, &iter.second.ID);
+	for (Texture2D& texture : Textures)
+		if (texture.ID == 0)
+			glGenTextures(1, &texture.ID);
 }
 
-Shader ResourceManager::loadShaderFromFile(const char* vShaderFile, const char* fShaderFile, const char* gShaderFile)
+bool ResourceManager::LoadTexture(TextureID id)
 {
-	std::string vertexCode;
-	std::string fragmentCode;
-	std::string geometryCode;
-	try {
-		std::ifstream vertexShaderFile(vShaderFile);
-		std::ifstream fragmentShaderFile(fShaderFile);
-		std::stringstream vShaderStream, fShaderStream;
-
-		vShaderStream << vertexShaderFile.rdbuf();
-		fShaderStream << fragmentShaderFile.rdbuf();
-		vertexShaderFile.close();
-		fragmentShaderFile.close();
-		vertexCode = vShaderStream.str();
-		fragmentCode = fShaderStream.str();
-
-		if (gShaderFile != nullptr) {
-			std::ifstream geometryShaderFile(gShaderFile);
-			std::stringstream gShaderStream;
-			gShaderStream << geometryShaderFile.rdbuf();
-			geometryShaderFile.close();
-			geometryCode = gShaderStream.str();
-		}
+	const TextureAsset& asset = TextureManifest[id];
+	if (asset.File == nullptr)
+	{
+		std::cout << "ERROR::RESOURCE_MANAGER: Texture " << id << " is missing from the asset manifest" << std::endl;
+		return false;
 	}
-	catch (std::exception e) {
-		std::cout << "ERROR::SHADER: Failed to read shader files" << std::endl;
+	TextureImage image;
+	bool cacheHit;
+	if (!TextureCache::Load(asset.File, asset.Alpha, asset.Mipmaps, image, cacheHit))
+		return false;
+	UploadTexture(id, image);
+	return true;
+}
+
+unsigned char* ResourceManager::DecodeImage(const char* file, bool alpha, int& width, int& height, std::string* error)
+{
+	// always ask for the channel count the texture format expects, whatever the file stores
+	int nrChannels;
+	unsigned char* data = stbi_load(file, &width, &height, &nrChannels, alpha ? 4 : 3);
+	if (data == nullptr)
+	{
+		// stb_image keeps the reason per thread, so it is read right here, on the decoding thread
+		std::string message = std::string("ERROR::TEXTURE: Failed to load ") + file + ": " + stbi_failure_reason();
+		if (error)
+			error->append(message).append("\n");
+		else
+			std::cout << message << std::endl;
 	}
-	const char* vShaderCode = vertexCode.c_str();
-	const char* fShaderCode = fragmentCode.c_str();
-	const char* gShaderCode = geometryCode.c_str();
+	return data;
+}
 
-	Shader shader;
-	shader.Compile(vShaderCode, fShaderCode, gShaderFile != nullptr ? gShaderCode : nullptr);
-	return shader;
+void ResourceManager::FreeImage(unsigned char* data)
+{
+	stbi_image_free(data);
 }
 
-Texture2D ResourceManager::loadTextureFromFile(const char* file, bool alpha)
+Texture2D& ResourceManager::UploadTexture(TextureID id, const TextureImage& image)
 {
-	Texture2D texture;
-	if (alpha) {
+	Texture2D& texture = Textures[id];
+	if (image.Channels == 4) {
 		texture.Internal_Format = GL_RGBA;
 		texture.Image_Format = GL_RGBA;
 	}
-
-	int width, height, nrChannels;
-	unsigned char* data = stbi_load(file, &width, &height, &nrChannels, 0);
-	texture.Generate(width, height, data);
-	stbi_image_free(data);
+	if (image.MipLevels > 1)
+		texture.Filter_Min = GL_LINEAR_MIPMAP_LINEAR;
+	// the text renderer leaves the unpack alignment at 1, so always set the image's own
+	glPixelStorei(GL_UNPACK_ALIGNMENT, image.RowAlignment);
+	texture.Generate(image.Width, image.Height, image.Pixels, image.MipLevels);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 	return texture;
 }
+
+void ResourceManager::Clear()
+{
+	for (Shader& shader : Shaders)
+		glDeleteProgram(shader.ID);
+	for (Texture2D& texture : Textures)
+		glDeleteTextures(1, &texture.ID);
+}
+
+bool ResourceManager::readFile(const char* file, std::string& contents)
+{
+	// read the whole file in one go instead of streaming it through a stringstream
+	std::ifstream stream(file, std::ios::binary | std::ios::ate);
+	if (!stream)
+		return false;
+	contents.resize(static_cast<size_t>(stream.tellg()));
+	stream.seekg(0);
+	return static_cast<bool>(stream.read(&contents[0], contents.size()));
+}
+
+Shader ResourceManager::loadShaderFromFile(const char* name, const char* vShaderFile, const char* fShaderFile, const char* gShaderFile)
+{
+	std::string vertexCode;
+	std::string fragmentCode;
+	std::string geometryCode;
+	const char* failed = nullptr;
+	if (!readFile(vShaderFile, vertexCode) || vertexCode.empty())
+		failed = vShaderFile;
+	else if (!readFile(fShaderFile, fragmentCode) || fragmentCode.empty())
+		failed = fShaderFile;
+	else if (gShaderFile != nullptr && !readFile(gShaderFile, geometryCode))
+		failed = gShaderFile;
+	if (failed != nullptr) {
+		std::cout << "ERROR::SHADER: Failed to read " << failed << std::endl;
+		loadFailed = true;
+	}
+	return CompileShader(name, vertexCode, fragmentCode, geometryCode);
+}
+
+Shader ResourceManager::CompileShader(const char* name, const std::string& vertexCode, const std::string& fragmentCode, const std::string& geometryCode)
+{
+	// linked programs are cached by source and driver, so only the first launch pays for compiling
+	double begin = NowMs();
+	uint64_t key = ShaderCache::Key(vertexCode, fragmentCode, geometryCode);
+	Shader shader;
+	bool cacheHit = ShaderCache::Load(key, shader);
+	if (!cacheHit)
+	{
+		if (shader.Compile(vertexCode.c_str(), fragmentCode.c_str(), geometryCode.empty() ? nullptr : geometryCode.c_str()))
+			ShaderCache::Store(key, shader);
+		else
+			loadFailed = true;
+	}
+	// block bindings are program state that program binaries don't carry, so they are set on both paths
+	if (shader.ID != 0)
+	{
+		shader.BindUniformBlock("Globals", GLOBALS_BINDING);
+		shader.BindUniformBlock("Palette", PALETTE_BINDING);
+	}
+	std::cout << "SHADER_CACHE: " << name << (cacheHit ? " hit, loaded in " : " miss, compiled in ")
+		<< NowMs() - begin << " ms" << std::endl;
+	return shader;
+}
@@ -0,0 +1,118 @@
+#include "shader_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "gl_extensions.h"
+#include "hash.h"
+#include "cache_files.h"
+
+const char* ShaderCache::Directory = "cache/shaders";
+
+struct ShaderCacheHeader {
+	uint32_t Magic;
+	uint32_t Format; // binary format reported by glGetProgramBinary
+	uint32_t Length;
+	uint32_t Reserved;
+	uint64_t Key;
+};
+
+static const uint32_t CACHE_MAGIC = 0x53504B42; // "BKPS"
+
+static std::string entryPathFor(uint64_t key)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+	return std::string(ShaderCache::Directory) + "/" + name;
+}
+
+uint64_t ShaderCache::Key(const std::string& vertexCode, const std::string& fragmentCode, const std::string& geometryCode)
+{
+	uint64_t key = HashBytes(nullptr, 0);
+	const GLenum driverStrings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+	for (GLenum name : driverStrings)
+	{
+		const char* value = reinterpret_cast<const char*>(glGetString(name));
+		if (value != nullptr)
+			key = HashBytes(value, strlen(value) + 1, key);
+	}
+	// hash the lengths too, so moving text between stages changes the key
+	const std::string* sources[] = { &vertexCode, &fragmentCode, &geometryCode };
+	for (const std::string* source : sources)
+	{
+		uint64_t length = source->size();
+		key = HashBytes(&length, sizeof(length), key);
+		key = HashBytes(source->data(), source->size(), key);
+	}
+	return key;
+}
+
+bool ShaderCache::Load(uint64_t key, Shader& shader)
+{
+	if (!GLExtensions::ProgramBinary)
+		return false;
+	std::string path = entryPathFor(key);
+	std::ifstream entry(path.c_str(), std::ios::binary | std::ios::ate);
+	if (!entry)
+		return false;
+	std::streamoff size = entry.tellg();
+	entry.seekg(0);
+	ShaderCacheHeader header;
+	if (!entry.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.Magic != CACHE_MAGIC || header.Key != key
+		|| header.Length == 0 || static_cast<std::streamoff>(header.Length) != size - static_cast<std::streamoff>(sizeof(header)))
+	{
+		// truncated or corrupt; drop it so the program is compiled and stored again
+		entry.close();
+		std::remove(path.c_str());
+		return false;
+	}
+	std::vector<char> binary(header.Length);
+	if (!entry.read(binary.data(), binary.size()))
+		return false;
+
+	unsigned int program = glCreateProgram();
+	GLExtensions::ProgramBinaryFunc(program, header.Format, binary.data(), header.Length);
+	int success = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		// typically a driver update; the caller compiles from source and replaces the entry
+		glDeleteProgram(program);
+		return false;
+	}
+	shader.ID = program;
+	return true;
+}
+
+void ShaderCache::Store(uint64_t key, const Shader& shader)
+{
+	if (!GLExtensions::ProgramBinary)
+		return;
+	int length = 0;
+	glGetProgramiv(shader.ID, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	GLExtensions::GetProgramBinary(shader.ID, length, nullptr, &format, binary.data());
+
+	ShaderCacheHeader header = { CACHE_MAGIC, format, static_cast<uint32_t>(length), 0, key };
+	MakeDirectories(Directory);
+	std::string path = entryPathFor(key);
+	std::string tempPath = path + ".tmp";
+	{
+		std::ofstream entry(tempPath.c_str(), std::ios::binary | std::ios::trunc);
+		entry.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		entry.write(binary.data(), binary.size());
+		if (!entry)
+		{
+			std::cout << "WARNING::SHADER_CACHE: Failed to write " << tempPath << std::endl;
+			return;
+		}
+	}
+	if (!CommitCacheFile(tempPath, path))
+		std::cout << "WARNING::SHADER_CACHE: Failed to replace " << path << std::endl;
+}
@@ -0,0 +1,35 @@
+#version 330 core
+layout (location = 0) in vec4 vertex; // unit quad <vec2 position, vec2 texCoords>
+// per brick, see BrickInstance
+layout (location = 1) in vec2 brickPosition;
+layout (location = 2) in vec2 brickSize;
+layout (location = 3) in uvec3 brickFlags; // x: palette index, y: solid, z: alive
+
+out vec2 TexCoords;
+out vec3 BrickColor;
+flat out uint Solid;
+
+// per-frame globals, see FrameGlobals
+layout (std140) uniform Globals
+{
+	mat4 projection;
+	vec2 viewport;
+	float time;
+	float renderScale;
+};
+
+// the level's BrickPalette, BRICK_PALETTE_SIZE entries
+layout (std140) uniform Palette
+{
+	vec4 colors[16];
+};
+
+void main()
+{
+	TexCoords = vertex.zw;
+	BrickColor = colors[brickFlags.x].rgb;
+	Solid = brickFlags.y;
+	// destroyed bricks collapse into a point and produce no fragments
+	vec2 position = brickPosition + vertex.xy * brickSize * float(brickFlags.z);
+	gl_Position = projection * vec4(position, 0.0, 1.0);
+}
@@ -1,12 +1,20 @@
 #version 330 core
 layout (location = 0) in vec4 vertex; //<vec2 position, vec2 texCoord>
+// per particle, streamed by ParticleGenerator
+layout (location = 1) in vec2 offset;
+layout (location = 2) in vec4 color;
 
 out vec2 TexCoords;
 out vec4 ParticleColor;
 
-uniform mat4 projection;
-uniform vec2 offset;
-uniform vec4 color;
+// per-frame globals, see FrameGlobals
+layout (std140) uniform Globals
+{
+	mat4 projection;
+	vec2 viewport;
+	float time;
+	float renderScale;
+};
 
 void main()
 {
@@ -1,13 +1,19 @@
 #version 330 core
-layout (location = 0) in vec4 vertex;
+layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>, already transformed by SpriteRenderer
 
 out vec2 TexCoords;
 
-uniform mat4 model;
-uniform mat4 projection;
+// per-frame globals, see FrameGlobals
+layout (std140) uniform Globals
+{
+	mat4 projection;
+	vec2 viewport;
+	float time;
+	float renderScale;
+};
 
 void main()
 {
 	TexCoords = vertex.zw;
-	gl_Position = projection * model * vec4(vertex.xy, 0.0, 1.0);
+	gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "soak_test.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "autoplayer.h"
+#include "game_batch.h"
+#include "game_world.h"
+#include "job_system.h"
+#include "timer.h"
+
+// a run still going after ten minutes of play is given up on; the autoplayer rarely loses, but bricks
+// walled in by solid ones can be out of its reach for a long time
+const float SOAK_MAX_SECONDS = 60.0f * 10.0f;
+
+// how one playthrough of a level went
+struct SoakRun {
+	bool		 Cleared;
+	bool		 Unfinished;
+	unsigned int Ticks;
+	double		 WorstTickMs;
+};
+
+static SoakRun playLevel(unsigned int level, unsigned int seed, unsigned int width, unsigned int height,
+	const std::shared_ptr<const std::vector<GameLevel>>& layouts, JobSystem& jobs, float dt, unsigned int maxTicks)
+{
+	GameWorld world(width, height, layouts, seed, jobs);
+	world.Start(level);
+	AutoPlayer player;
+	SoakRun run = { false, true, 0, 0.0 };
+	while (run.Ticks < maxTicks)
+	{
+		WorldInput input = GameBatch::Input(player.Decide(world, dt), dt);
+		double start = NowMs();
+		world.Step(input, dt);
+		run.WorstTickMs = std::max(run.WorstTickMs, NowMs() - start);
+		++run.Ticks;
+		if (world.State != GAME_ACTIVE)
+		{
+			run.Cleared = world.State == GAME_WIN;
+			run.Unfinished = false;
+			break;
+		}
+	}
+	return run;
+}
+
+int RunSoakTest(unsigned int runsPerLevel, unsigned int width, unsigned int height, float tickRate)
+{
+	JobSystem jobs;
+	std::shared_ptr<const std::vector<GameLevel>> layouts = GameWorld::LoadLayouts(width, height);
+	const float dt = 1.0f / tickRate;
+	const unsigned int maxTicks = static_cast<unsigned int>(tickRate * SOAK_MAX_SECONDS);
+	unsigned int runs = runsPerLevel * LEVEL_COUNT;
+	std::vector<SoakRun> results(runs);
+	double start = NowMs();
+	// run r plays level r % LEVEL_COUNT, so every chunk of runs mixes the levels
+	jobs.ParallelFor(runs, 1, [&](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int r = begin; r < end; ++r)
+			results[r] = playLevel(r % LEVEL_COUNT, r + 1, width, height, layouts, jobs, dt, maxTicks);
+	});
+	double seconds = (NowMs() - start) / 1000.0;
+
+	std::cout << "SOAK: " << runs << " runs in " << std::fixed << std::setprecision(1) << seconds << " s on "
+		<< jobs.ThreadCount() << " threads" << std::endl;
+	for (unsigned int level = 0; level < LEVEL_COUNT; ++level)
+	{
+		unsigned int cleared = 0, unfinished = 0;
+		unsigned long long ticks = 0;
+		double worstMs = 0.0;
+		for (unsigned int r = level; r < runs; r += LEVEL_COUNT)
+		{
+			cleared += results[r].Cleared;
+			unfinished += results[r].Unfinished;
+			ticks += results[r].Ticks;
+			worstMs = std::max(worstMs, results[r].WorstTickMs);
+		}
+		std::cout << "  " << std::left << std::setw(18) << LEVEL_FILES[level] << std::right << " | cleared "
+			<< std::setprecision(1) << 100.0 * cleared / runsPerLevel << "% | " << ticks / runsPerLevel
+			<< " ticks per run | worst tick " << std::setprecision(3) << worstMs << " ms | " << unfinished << " unfinished" << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#ifndef SOAK_TEST_H
+#define SOAK_TEST_H
+
+// RunSoakTest lets the AutoPlayer play every level runsPerLevel times
+// without a window, spread over all cores, each run with its own seed.
+// A run ends when the level is cleared, the last life is lost or it
+// takes longer than SOAK_MAX_SECONDS of game time at tickRate. Prints
+// per level the clear rate, the ticks a run took on average, the worst
+// time of a single tick and how many runs were given up on.
+// Returns the process exit code.
+int RunSoakTest(unsigned int runsPerLevel, unsigned int width, unsigned int height, float tickRate);
+
+#endif
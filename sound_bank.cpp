@@ -0,0 +1,93 @@
+#include "sound_bank.h"
+
+#include <iostream>
+
+#include "timer.h"
+
+SoundBank::SoundBank(AudioDevice& device)
+	: Played(0), Coalesced(0), Dropped(0), device(device), loaded(), playing()
+{
+	for (unsigned int i = 0; i < AUDIO_COUNT; ++i)
+		this->lastPlayed[i] = -1.0e9;
+	this->voices.reserve(SOUND_BANK_MAX_VOICES);
+}
+
+SoundBank::~SoundBank()
+{
+	for (Voice& voice : this->voices)
+		this->device.Release(voice.Handle);
+}
+
+bool SoundBank::Load()
+{
+	bool loaded = true;
+	for (unsigned int i = 0; i < AUDIO_COUNT; ++i)
+	{
+		const AudioAsset& asset = AudioManifest[i];
+		if (asset.File == nullptr)
+		{
+			std::cout << "ERROR::SOUND_BANK: Sound " << i << " is missing from the asset manifest" << std::endl;
+			loaded = false;
+			continue;
+		}
+		this->loaded[i] = this->device.Load(static_cast<AudioID>(i), asset);
+		if (!this->loaded[i])
+		{
+			std::cout << "ERROR::SOUND_BANK: Failed to load " << asset.Name << " from " << asset.File << " on the "
+				<< this->device.Name() << " device" << std::endl;
+			loaded = false;
+		}
+	}
+	return loaded;
+}
+
+bool SoundBank::Play(AudioID id, bool loop)
+{
+	if (!this->loaded[id])
+		return false;
+	const AudioAsset& asset = AudioManifest[id];
+	double now = NowMs();
+	if (now - this->lastPlayed[id] < asset.CoalesceMs)
+	{
+		++this->Coalesced;
+		return false;
+	}
+	this->reap();
+	if (this->playing[id] >= asset.MaxVoices || this->voices.size() >= SOUND_BANK_MAX_VOICES)
+	{
+		++this->Dropped;
+		return false;
+	}
+	VoiceHandle handle = this->device.Play(id, loop);
+	if (!handle)
+		return false;
+	Voice voice = { handle, id };
+	this->voices.push_back(voice);
+	++this->playing[id];
+	this->lastPlayed[id] = now;
+	++this->Played;
+	return true;
+}
+
+void SoundBank::reap()
+{
+	for (size_t i = 0; i < this->voices.size();)
+	{
+		Voice& voice = this->voices[i];
+		if (!this->device.Finished(voice.Handle))
+		{
+			++i;
+			continue;
+		}
+		this->device.Release(voice.Handle);
+		--this->playing[voice.Id];
+		voice = this->voices.back();
+		this->voices.pop_back();
+	}
+}
+
+void SoundBank::PrintStats() const
+{
+	std::cout << "SOUND_BANK: " << this->Played << " sounds played, " << this->Coalesced << " coalesced, "
+		<< this->Dropped << " dropped for lack of voices" << std::endl;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#ifndef SOUND_BANK_H
+#define SOUND_BANK_H
+
+#include <vector>
+
+#include "asset_manifest.h"
+#include "audio_device.h"
+
+// voices playing at once, all sounds together; triggers beyond it are dropped
+const unsigned int SOUND_BANK_MAX_VOICES = 16;
+
+/// SoundBank loads every sound of the asset manifest once, at startup,
+/// and plays them by AudioID, so gameplay never names a file or waits on
+/// the disk. It keeps the number of voices in check: a trigger is
+/// dropped when the same sound played within its CoalesceMs, when its
+/// MaxVoices copies are still playing, or when SOUND_BANK_MAX_VOICES
+/// voices are. It plays through whichever AudioDevice it is given.
+/// Use it from one thread only.
+class SoundBank
+{
+public:
+	unsigned int Played, Coalesced, Dropped; // triggers that played, that came too soon and that found no free voice
+	explicit SoundBank(AudioDevice& device);
+	~SoundBank();
+	bool Load(); // returns false if any sound failed to load; those stay silent
+	bool Play(AudioID id, bool loop = false); // returns whether the sound started
+	void PrintStats() const;
+private:
+	struct Voice {
+		VoiceHandle Handle;
+		AudioID		Id;
+	};
+	AudioDevice&	   device;
+	bool			   loaded[AUDIO_COUNT];
+	double			   lastPlayed[AUDIO_COUNT]; // NowMs() of the last trigger that played
+	unsigned int	   playing[AUDIO_COUNT];	// voices of each sound
+	std::vector<Voice> voices;
+	void reap(); // frees the voices that finished playing
+};
+
+#endif
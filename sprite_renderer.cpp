@@ -1,9 +1,38 @@
 #include "sprite_renderer.h"
 
-SpriteRenderer::SpriteRenderer(Shader& shader)
+#include <cmath>
+
+// writes the 6 <vec2 position, vec2 texCoords> vertices of a quad rotated by rotate degrees around its center
+static void writeQuad(float* vertices, glm::vec2 position, glm::vec2 size, float rotate)
+{
+	static const float corners[6][4] = {
+		// pos      // tex
+		{ 0.0f, 1.0f, 0.0f, 1.0f },
+		{ 1.0f, 0.0f, 1.0f, 0.0f },
+		{ 0.0f, 0.0f, 0.0f, 0.0f },
+
+		{ 0.0f, 1.0f, 0.0f, 1.0f },
+		{ 1.0f, 1.0f, 1.0f, 1.0f },
+		{ 1.0f, 0.0f, 1.0f, 0.0f }
+	};
+	float radians = glm::radians(rotate);
+	float c = std::cos(radians), s = std::sin(radians);
+	glm::vec2 center = position + 0.5f * size;
+	for (unsigned int i = 0; i < 6; ++i)
+	{
+		float x = (corners[i][0] - 0.5f) * size.x, y = (corners[i][1] - 0.5f) * size.y;
+		vertices[i * 4 + 0] = center.x + c * x - s * y;
+		vertices[i * 4 + 1] = center.y + s * x + c * y;
+		vertices[i * 4 + 2] = corners[i][2];
+		vertices[i * 4 + 3] = corners[i][3];
+	}
+}
+
+SpriteRenderer::SpriteRenderer(Shader& shader, StreamBuffer& stream, JobSystem& jobs)
+	: shader(shader), stream(stream), jobs(jobs)
 {
-	this->shader = shader;
 	this->initRenderData();
+	this->colorLocation = glGetUniformLocation(this->shader.ID, "spriteColor");
 }
 
 SpriteRenderer::~SpriteRenderer()
@@ -13,51 +42,61 @@ SpriteRenderer::~SpriteRenderer()
 
 void SpriteRenderer::DrawSprite(Texture2D& texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color)
 {
-	this->shader.Use();
-	glm::mat4 model = glm::mat4(1.0f);
-	model = glm::translate(model, glm::vec3(position, 0.0f));
-
-	model = glm::translate(model, glm::vec3(0.5f * size.x, 0.5f * size.y, 0.0f));
-	model = glm::rotate(model, glm::radians(rotate), glm::vec3(0.0f, 0.0f, 1.0f));
-	model = glm::translate(model, glm::vec3(-0.5f * size.x, -0.5f * size.y, 0.0f));
-
-	model = glm::scale(model, glm::vec3(size, 1.0f));
+	RenderQueue::Execute(this->Sprite(texture, position, size, rotate, color));
+}
 
-	this->shader.SetMatrix4("model", model);
-	this->shader.SetVector3f("spriteColor", color);
+RenderCommand SpriteRenderer::Sprite(const Texture2D& texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color)
+{
+	// the quad is transformed here and streamed, rather than sending the model matrix as a uniform
+	RenderCommand command = { this->shader.ID, this->quadVAO, texture.ID, 0, 0, 0, this->colorLocation, color };
+	StreamAllocation allocation = this->stream.Allocate(6 * 4 * sizeof(float), 4 * sizeof(float));
+	if (allocation.Data == nullptr)
+		return command; // nothing to draw
+	writeQuad(static_cast<float*>(allocation.Data), position, size, rotate);
+	this->stream.Commit();
+	command.First = static_cast<int>(allocation.Offset / (4 * sizeof(float)));
+	command.Count = 6;
+	return command;
+}
 
-	glActiveTexture(GL_TEXTURE0);
-	texture.Bind();
+int SpriteRenderer::Prepare(const SpriteState* sprites, unsigned int count)
+{
+	if (count == 0)
+		return 0;
+	StreamAllocation allocation = this->stream.Allocate(count * 6 * 4 * sizeof(float), 4 * sizeof(float));
+	if (allocation.Data == nullptr)
+		return -1;
+	float* vertices = static_cast<float*>(allocation.Data);
+	this->jobs.ParallelFor(count, SPRITE_JOB_CHUNK, [sprites, vertices](unsigned int begin, unsigned int end)
+	{
+		for (unsigned int i = begin; i < end; ++i)
+			writeQuad(vertices + i * 6 * 4, sprites[i].Position, sprites[i].Size, sprites[i].Rotation);
+	});
+	this->stream.Commit();
+	return static_cast<int>(allocation.Offset / (4 * sizeof(float)));
+}
 
-	glBindVertexArray(this->quadVAO);
-	glDrawArrays(GL_TRIANGLES, 0, 6);
-	glBindVertexArray(0);
+void SpriteRenderer::PushSprites(RenderQueue& queue, const std::vector<SpriteState>& sprites)
+{
+	int first = this->Prepare(sprites.data(), static_cast<unsigned int>(sprites.size()));
+	if (first < 0)
+		return;
+	for (const SpriteState& sprite : sprites)
+	{
+		RenderCommand command = { this->shader.ID, this->quadVAO, sprite.Sprite.ID, first, 6, 0, this->colorLocation, sprite.Color };
+		queue.Push(sprite.Layer, BLEND_ALPHA, command);
+		first += 6;
+	}
 }
 
 void SpriteRenderer::initRenderData()
 {
-	unsigned int VBO;
-	float vertices[] = {
-		// pos      // tex
-		0.0f, 1.0f, 0.0f, 1.0f,
-		1.0f, 0.0f, 1.0f, 0.0f,
-		0.0f, 0.0f, 0.0f, 0.0f,
-
-		0.0f, 1.0f, 0.0f, 1.0f,
-		1.0f, 1.0f, 1.0f, 1.0f,
-		1.0f, 0.0f, 1.0f, 0.0f
-	};
-
+	// vertices are read straight from the stream buffer; DrawSprite picks the first vertex
 	glGenVertexArrays(1, &this->quadVAO);
-	glGenBuffers(1, &VBO);
-
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
 	glBindVertexArray(this->quadVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, this->stream.ID);
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
-
 }
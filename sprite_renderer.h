@@ -1,20 +1,51 @@
 #pragma once
+#include <vector>
+
 #include "glm/glm.hpp"
 
 #include "shader.h"
 #include "texture.h"
+#include "stream_buffer.h"
+#include "render_queue.h"
+#include "job_system.h"
+
+// sprites per job when their quads are prepared; fewer are prepared on the calling thread
+const unsigned int SPRITE_JOB_CHUNK = 1024;
+
+// one sprite of a frame and the layer it is drawn on
+struct SpriteState {
+	Texture2D	Sprite;
+	glm::vec2	Position, Size;
+	glm::vec3	Color;
+	float		Rotation;
+	RenderLayer Layer;
+};
 
 class SpriteRenderer
 {
 public:
-	SpriteRenderer(Shader& shader);
+	SpriteRenderer(Shader& shader, StreamBuffer& stream, JobSystem& jobs);
 	~SpriteRenderer();
 
+	// streams the quads of count sprites, transformed in parallel chunks that each write their own
+	// range; returns the first vertex (sprite i starts 6 * i later), or -1 if the stream is full
+	int Prepare(const SpriteState* sprites, unsigned int count);
+	// prepares the sprites and queues one draw per sprite on its layer
+	void PushSprites(RenderQueue& queue, const std::vector<SpriteState>& sprites);
+
+	// streams the sprite's quad and returns the draw for a RenderQueue
+	RenderCommand Sprite(const Texture2D& texture, glm::vec2 position,
+		glm::vec2 size = glm::vec2(10.0f, 10.0f), float rotate = 0.0f,
+		glm::vec3 color = glm::vec3(1.0f));
+	// draws the sprite right away
 	void DrawSprite(Texture2D& texture, glm::vec2 position,
 		glm::vec2 size = glm::vec2(10.0f, 10.0f), float rotate = 0.0f,
 		glm::vec3 color = glm::vec3(1.0f));
 private:
 	Shader		 shader;
+	StreamBuffer& stream; // the transformed quad corners are streamed each draw
+	JobSystem&	 jobs;
 	unsigned int quadVAO;
+	int			 colorLocation;
 	void initRenderData();
 };
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include "static_layer.h"
+
+#include <iostream>
+
+StaticLayer::StaticLayer(unsigned int width, unsigned int height)
+	: Width(width), Height(height), Rebuilds(0), FBO(0), generation(0), revision(0)
+{
+	glGenFramebuffers(1, &this->FBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
+	this->Texture.Internal_Format = GL_RGBA8;
+	this->Texture.Image_Format = GL_RGBA;
+	this->Texture.Wrap_S = this->Texture.Wrap_T = GL_CLAMP_TO_EDGE;
+	this->Texture.Generate(width, height, NULL);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->Texture.ID, 0);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "ERROR::STATIC_LAYER: Failed to initialize FBO" << std::endl;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+StaticLayer::~StaticLayer()
+{
+	glDeleteFramebuffers(1, &this->FBO);
+	glDeleteTextures(1, &this->Texture.ID);
+}
+
+void StaticLayer::Draw(RenderQueue& queue, SpriteRenderer& renderer, BrickRenderer& bricks, Texture2D& background, const GameLevel& level)
+{
+	// the rebuild targets the layer's own framebuffer, so it is drawn right away rather than queued
+	if (this->generation != level.Generation || this->revision != level.Revision)
+		this->rebuild(renderer, bricks, background, level);
+	// the texture is stored bottom-up, so the quad is flipped vertically
+	queue.Push(LAYER_BACKGROUND, BLEND_ALPHA, renderer.Sprite(this->Texture, glm::vec2(0.0f, static_cast<float>(this->Height)),
+		glm::vec2(static_cast<float>(this->Width), -static_cast<float>(this->Height))));
+}
+
+void StaticLayer::rebuild(SpriteRenderer& renderer, BrickRenderer& bricks, Texture2D& background, const GameLevel& level)
+{
+	// the layer is drawn in the middle of a frame, so put the caller's target back afterwards
+	GLint previousFBO, viewport[4];
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFBO);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, this->FBO);
+	glViewport(0, 0, this->Width, this->Height);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	// keep the layer's alpha opaque where bricks are blended over the background
+	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	renderer.DrawSprite(background, glm::vec2(0.0f, 0.0f), glm::vec2(this->Width, this->Height), 0.0f);
+	bricks.Draw(level);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFBO);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	this->generation = level.Generation;
+	this->revision = level.Revision;
+	++this->Rebuilds;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#ifndef STATIC_LAYER_H
+#define STATIC_LAYER_H
+
+#include <glad/glad.h>
+
+#include "texture.h"
+#include "sprite_renderer.h"
+#include "game_level.h"
+#include "brick_renderer.h"
+#include "render_queue.h"
+
+// StaticLayer keeps the parts of the scene that rarely change (the
+// background and the level's bricks) in an offscreen texture, so a
+// frame composites them with a single quad instead of one draw call
+// per brick. The texture is redrawn only when another level is shown
+// or the level's bricks change (see GameLevel::Generation and Revision),
+// so a copy of the level shows the same cached texture.
+class StaticLayer
+{
+public:
+	Texture2D	 Texture;
+	unsigned int Width, Height;
+	unsigned int Rebuilds; // times the layer had to be redrawn
+	StaticLayer(unsigned int width, unsigned int height);
+	~StaticLayer();
+	// queues background and level on LAYER_BACKGROUND, redrawing the cached layer first if it is out of date
+	void Draw(RenderQueue& queue, SpriteRenderer& renderer, BrickRenderer& bricks, Texture2D& background, const GameLevel& level);
+	void Invalidate() { this->generation = 0; }
+private:
+	unsigned int	 FBO;
+	unsigned int	 generation; // GameLevel::Generation and Revision the texture currently shows
+	unsigned int	 revision;
+	void rebuild(SpriteRenderer& renderer, BrickRenderer& bricks, Texture2D& background, const GameLevel& level);
+};
+
+#endif
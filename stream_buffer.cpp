@@ -0,0 +1,141 @@
+#include "stream_buffer.h"
+
+#include <iostream>
+
+#include "gl_extensions.h"
+#include "timer.h"
+
+// how long a frame may wait for its region before giving up on it (ns); only reached if the GPU is hung
+const GLuint64 STREAM_FENCE_TIMEOUT = 1000000000;
+
+StreamBuffer::StreamBuffer(size_t regionSize)
+	: ID(0), Frames(0), regionSize(regionSize), region(0), head(0), mapped(nullptr), pendingUnmap(false)
+{
+	for (unsigned int i = 0; i < REGIONS; ++i)
+		this->fences[i] = 0;
+	glGenBuffers(1, &this->ID);
+	glBindBuffer(GL_ARRAY_BUFFER, this->ID);
+	if (GLExtensions::BufferStorage)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GLExtensions::BufferStorageFunc(GL_ARRAY_BUFFER, REGIONS * regionSize, NULL, flags);
+		this->mapped = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, REGIONS * regionSize, flags));
+		if (this->mapped == nullptr)
+		{
+			// immutable storage cannot be orphaned, so fall back to a fresh mutable buffer
+			std::cout << "ERROR::STREAM_BUFFER: Failed to map buffer persistently, orphaning instead" << std::endl;
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			glDeleteBuffers(1, &this->ID);
+			glGenBuffers(1, &this->ID);
+			glBindBuffer(GL_ARRAY_BUFFER, this->ID);
+			glBufferData(GL_ARRAY_BUFFER, REGIONS * regionSize, NULL, GL_STREAM_DRAW);
+		}
+	}
+	else
+		glBufferData(GL_ARRAY_BUFFER, REGIONS * regionSize, NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+StreamBuffer::~StreamBuffer()
+{
+	for (unsigned int i = 0; i < REGIONS; ++i)
+		if (this->fences[i])
+			glDeleteSync(this->fences[i]);
+	if (this->mapped)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, this->ID);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	glDeleteBuffers(1, &this->ID);
+}
+
+void StreamBuffer::BeginFrame()
+{
+	this->frame = StreamStats();
+	this->head = 0;
+	if (this->mapped)
+	{
+		// the GPU may still be drawing from this region three frames back
+		GLsync fence = this->fences[this->region];
+		if (fence)
+		{
+			if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+			{
+				double begin = NowMs();
+				glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, STREAM_FENCE_TIMEOUT);
+				++this->frame.FenceWaits;
+				this->frame.WaitMs += NowMs() - begin;
+			}
+			glDeleteSync(fence);
+			this->fences[this->region] = 0;
+		}
+	}
+	else if (this->region == 0)
+	{
+		// hand the old storage to the driver and start writing into fresh memory
+		glBindBuffer(GL_ARRAY_BUFFER, this->ID);
+		glBufferData(GL_ARRAY_BUFFER, REGIONS * this->regionSize, NULL, GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}
+
+void StreamBuffer::EndFrame()
+{
+	if (this->mapped)
+		this->fences[this->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	this->region = (this->region + 1) % REGIONS;
+	this->LastFrame = this->frame;
+	this->Total.BytesStreamed += this->frame.BytesStreamed;
+	this->Total.FenceWaits += this->frame.FenceWaits;
+	this->Total.WaitMs += this->frame.WaitMs;
+	this->Total.Overflows += this->frame.Overflows;
+	++this->Frames;
+}
+
+StreamAllocation StreamBuffer::Allocate(size_t size, size_t alignment)
+{
+	StreamAllocation allocation = { nullptr, 0 };
+	size_t start = (this->head + alignment - 1) / alignment * alignment;
+	if (start + size > this->regionSize)
+	{
+		++this->frame.Overflows;
+		return allocation;
+	}
+	this->head = start + size;
+	this->frame.BytesStreamed += size;
+	allocation.Offset = static_cast<GLintptr>(this->region * this->regionSize + start);
+	if (this->mapped)
+		allocation.Data = this->mapped + allocation.Offset;
+	else
+	{
+		// nothing written this cycle overlaps the range, so there is nothing to synchronize with
+		glBindBuffer(GL_ARRAY_BUFFER, this->ID);
+		allocation.Data = glMapBufferRange(GL_ARRAY_BUFFER, allocation.Offset, size,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		this->pendingUnmap = allocation.Data != nullptr;
+		glBindBuffer(GL_ARRAY_BUFFER, 0); // the mapping stays valid while unbound
+	}
+	return allocation;
+}
+
+void StreamBuffer::Commit()
+{
+	// the persistent mapping is coherent, so only the fallback has anything to do
+	if (!this->pendingUnmap)
+		return;
+	glBindBuffer(GL_ARRAY_BUFFER, this->ID);
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	this->pendingUnmap = false;
+}
+
+void StreamBuffer::PrintStats() const
+{
+	if (this->Frames == 0)
+		return;
+	std::cout << "STREAM_BUFFER: " << (this->mapped ? "persistent" : "orphaning") << ", "
+		<< this->Total.BytesStreamed / this->Frames << " bytes/frame avg, last frame " << this->LastFrame.BytesStreamed << " bytes, "
+		<< this->Total.FenceWaits << " fence waits (" << this->Total.WaitMs << " ms), "
+		<< this->Total.Overflows << " overflows over " << this->Frames << " frames" << std::endl;
+}
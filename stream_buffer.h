@@ -0,0 +1,61 @@
+#pragma once
+
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <cstddef>
+
+#include <glad/glad.h>
+
+// per-frame streaming statistics
+struct StreamStats {
+	size_t		 BytesStreamed;
+	unsigned int FenceWaits;	// frames that had to wait for the GPU to release their region
+	double		 WaitMs;		// time spent in those waits
+	unsigned int Overflows;		// allocations that did not fit into their frame's region
+
+	StreamStats() : BytesStreamed(0), FenceWaits(0), WaitMs(0.0), Overflows(0) { }
+};
+
+// where an allocation ended up; Data is nullptr when the frame's region is full
+struct StreamAllocation {
+	void*	 Data;
+	GLintptr Offset; // byte offset into the buffer, for attribute pointers and draw calls
+};
+
+// StreamBuffer is one vertex buffer that renderers sub-allocate their
+// per-frame dynamic data from, instead of rewriting their own small
+// buffers with glBufferSubData. It is split into REGIONS frame regions
+// used round-robin. With ARB_buffer_storage the buffer stays mapped and
+// every region is guarded by a fence, so a frame only waits if the GPU
+// is still reading the region it is about to overwrite. Without it the
+// buffer is orphaned each time the regions wrap around and allocations
+// are mapped unsynchronized.
+// Every frame must be enclosed in BeginFrame()/EndFrame(), and every
+// allocation written and then committed before the next one is made.
+class StreamBuffer
+{
+public:
+	static const unsigned int REGIONS = 3;
+	unsigned int ID;
+	StreamStats	 LastFrame, Total;
+	unsigned int Frames;
+	StreamBuffer(size_t regionSize = 1024 * 1024);
+	~StreamBuffer();
+	void BeginFrame();
+	void EndFrame();
+	StreamAllocation Allocate(size_t size, size_t alignment);
+	void Commit(); // makes the last allocation visible to the GPU
+	bool Persistent() const { return this->mapped != nullptr; }
+	void PrintStats() const;
+private:
+	size_t		   regionSize;
+	unsigned int   region;	// current frame region
+	size_t		   head;	// next free byte in the current region
+	unsigned char* mapped;	// persistent mapping, nullptr when orphaning
+	bool		   pendingUnmap;
+	GLsync		   fences[REGIONS];
+	StreamStats	   frame;
+};
+
+#endif
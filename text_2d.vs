@@ -2,7 +2,14 @@
 layout (location = 0) in vec4 vertex; // <vec2 pos, vec2 tex>
 out vec2 TexCoords;
 
-uniform mat4 projection;
+// per-frame globals, see FrameGlobals
+layout (std140) uniform Globals
+{
+	mat4 projection;
+	vec2 viewport;
+	float time;
+	float renderScale;
+};
 
 void main()
 {
@@ -1,24 +1,23 @@
+#include <cstring>
 #include <iostream>
 
-#include <glm/gtc/matrix_transform.hpp>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
 #include "text_renderer.h"
 #include "resource_manager.h"
 
-TextRenderer::TextRenderer(unsigned int width, unsigned int height)
+TextRenderer::TextRenderer(StreamBuffer& stream, RenderQueue& queue)
+	: stream(stream), queue(queue)
 {
-	//load and configure shader
-	this->TextShader = ResourceManager::LoadShader("text_2d.vs", "text_2d.fs", nullptr, "text");
-	this->TextShader.SetMatrix4("projection", glm::ortho(0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f), true);
-	this->TextShader.SetInteger("text", 0);
-	//configure VAO/VBO for texture quads
+	//configure shader (loaded with the rest of the asset manifest)
+	this->TextShader = ResourceManager::GetShader(SHADER_TEXT);
+	this->TextShader.SetInteger("text", 0, true); // the projection comes from the Globals block
+	this->colorLocation = glGetUniformLocation(this->TextShader.ID, "textColor");
+	//configure VAO for texture quads; the vertices come from the stream buffer
 	glGenVertexArrays(1, &this->VAO);
-	glGenBuffers(1, &this->VBO);
 	glBindVertexArray(this->VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, this->stream.ID);
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -75,23 +74,21 @@ void TextRenderer::Load(std::string font, unsigned int fontSize)
 
 void TextRenderer::RenderText(std::string text, float x, float y, float scale, glm::vec3 color)
 {
-	//activate corresponding render state
-	this->TextShader.Use();
-	this->TextShader.SetVector3f("textColor", color);
-	glActiveTexture(GL_TEXTURE0);
-	glBindVertexArray(this->VAO);
-
-	//iterate throug all characters
-	std::string::const_iterator c;
-	for (c = text.begin(); c != text.end(); c++) {
-		Character ch = Characters[*c];
+	//all glyph quads are written up front, so drawing never waits on a buffer update
+	const unsigned int vertexSize = 4 * sizeof(float);
+	StreamAllocation allocation = this->stream.Allocate(text.size() * 6 * vertexSize, vertexSize);
+	if (allocation.Data == nullptr)
+		return;
+	float (*quads)[6][4] = static_cast<float (*)[6][4]>(allocation.Data);
+	float cursor = x;
+	for (unsigned int i = 0; i < text.size(); ++i) {
+		Character ch = Characters[text[i]];
 
-		float xpos = x + ch.Bearing.x * scale;
+		float xpos = cursor + ch.Bearing.x * scale;
 		float ypos = y + (this->Characters['H'].Bearing.y - ch.Bearing.y) * scale;
 
 		float w = ch.Size.x * scale;
 		float h = ch.Size.y * scale;
-		// update VBO for each character
 		float vertices[6][4] = {
 			{ xpos,		ypos + h,	0.0f, 1.0f},
 			{ xpos + w, ypos,		1.0f, 0.0f},
@@ -101,14 +98,17 @@ void TextRenderer::RenderText(std::string text, float x, float y, float scale, g
 			{ xpos + w, ypos + h,   1.0f, 1.0f},
 			{ xpos + w, ypos,		1.0f, 0.0f}
 		};
-		// render glyph texture over quad
-		glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-		glBindBuffer(GL_ARRAY_BUFFER, this->VBO); // update content of VBO memory
-		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // be sue to use glBufferSubData and not glbufferData
-		glDrawArrays(GL_TRIANGLES, 0, 6); // render quad
+		memcpy(quads[i], vertices, sizeof(vertices));
 		//now advance cursors for next glyph
-		x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (1/64th times 2^6 = 64)
+		cursor += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (1/64th times 2^6 = 64)
+	}
+	this->stream.Commit();
+
+	//one draw per glyph, as every glyph has its own texture
+	int first = static_cast<int>(allocation.Offset / vertexSize);
+	for (unsigned int i = 0; i < text.size(); ++i) {
+		RenderCommand command = { this->TextShader.ID, this->VAO, this->Characters[text[i]].TextureID, first + static_cast<int>(i) * 6, 6, 0,
+			this->colorLocation, color };
+		this->queue.Push(LAYER_TEXT, BLEND_ALPHA, command);
 	}
-	glBindVertexArray(0);
-	glBindTexture(GL_TEXTURE_2D, 0);
 }
@@ -10,6 +10,8 @@
 
 #include "texture.h"
 #include "shader.h"
+#include "stream_buffer.h"
+#include "render_queue.h"
 
 // Holds all state information relevant to a character as loaded using FreeType
 struct Character {
@@ -27,11 +29,14 @@ class TextRenderer
 public:
 	std::map<char, Character> Characters; // holds a list of pre-compiled Characters
 	Shader TextShader; // shader used for text rendering
-	TextRenderer(unsigned int width, unsigned int height); // constructor
+	TextRenderer(StreamBuffer& stream, RenderQueue& queue); // constructor
 	void Load(std::string font, unsigned int fontSize); // pre-compiles a list of characters from the given font
-	void RenderText(std::string text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+	void RenderText(std::string text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f)); // queued on LAYER_TEXT
 private:
-	unsigned int VAO, VBO; // render state
+	unsigned int VAO; // render state
+	StreamBuffer& stream; // glyph quads of a string are streamed in one allocation
+	RenderQueue&  queue;  // glyphs are drawn when the queue is flushed, grouped by glyph texture
+	int			  colorLocation;
 };
 #endif // !TEXT_RENDERER_H
 
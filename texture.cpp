@@ -1,21 +1,39 @@
+#include <algorithm>
 #include <iostream>
 
 #include "texture.h"
 
 Texture2D::Texture2D()
-	: Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR),
+	: ID(0), Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR),
 	Filter_Max(GL_LINEAR)
 {
-	glGenTextures(1, &this->ID);
 }
 
-void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char* data)
+void Texture2D::Generate(unsigned int width, unsigned int height, const unsigned char* data, unsigned int mipLevels)
 {
 	this->Width = width;
 	this->Height = height;
+	// the GL name is created on first upload, so textures can be declared before a context exists
+	if (this->ID == 0)
+		glGenTextures(1, &this->ID);
 
 	glBindTexture(GL_TEXTURE_2D, this->ID);
 	glTexImage2D(GL_TEXTURE_2D, 0, this->Internal_Format, width, height, 0, this->Image_Format, GL_UNSIGNED_BYTE, data);
+	if (mipLevels > 1)
+	{
+		int alignment;
+		glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+		unsigned int channels = this->Image_Format == GL_RGBA ? 4 : 3;
+		for (unsigned int level = 1; level < mipLevels; ++level)
+		{
+			// step past the previous level, whose rows are padded to the unpack alignment
+			data += (width * channels + alignment - 1) / alignment * alignment * height;
+			width = std::max(1u, width / 2);
+			height = std::max(1u, height / 2);
+			glTexImage2D(GL_TEXTURE_2D, level, this->Internal_Format, width, height, 0, this->Image_Format, GL_UNSIGNED_BYTE, data);
+		}
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipLevels - 1);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, this->Wrap_S);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, this->Wrap_T);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->Filter_Min);
@@ -0,0 +1,295 @@
+#include "texture_cache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "hash.h"
+#include "cache_files.h"
+#include "resource_manager.h"
+
+const char* TextureCache::Directory = "cache/textures";
+
+// layout of a cache entry: this header followed by the mip levels, largest first
+struct TextureCacheHeader {
+	uint32_t Magic;
+	uint32_t Version;
+	uint64_t SourceTime;  // modification time of the source image
+	uint64_t SourceSize;
+	uint64_t SourceHash;  // HashBytes of the source file contents
+	uint32_t Width, Height;
+	uint32_t Channels, MipLevels;
+	uint32_t RowAlignment;
+	uint32_t Mipmapped;	  // whether a mip chain was requested when the entry was built
+	uint32_t Reserved[2];
+};
+static_assert(sizeof(TextureCacheHeader) == 64, "cache header layout must not change silently");
+
+static const uint32_t CACHE_MAGIC = 0x43544B42; // "BKTC"
+static const uint32_t CACHE_VERSION = 1;
+static const unsigned int ROW_ALIGNMENT = 4;
+
+static size_t rowPitch(unsigned int width, unsigned int channels)
+{
+	size_t pitch = static_cast<size_t>(width) * channels;
+	return (pitch + ROW_ALIGNMENT - 1) / ROW_ALIGNMENT * ROW_ALIGNMENT;
+}
+
+static size_t imageSize(unsigned int width, unsigned int height, unsigned int channels, unsigned int levels)
+{
+	size_t size = 0;
+	for (unsigned int level = 0; level < levels; ++level)
+	{
+		size += rowPitch(width, channels) * height;
+		width = std::max(1u, width / 2);
+		height = std::max(1u, height / 2);
+	}
+	return size;
+}
+
+static bool statSource(const char* file, uint64_t& time, uint64_t& size)
+{
+	struct stat st;
+	if (stat(file, &st) != 0)
+		return false;
+	time = static_cast<uint64_t>(st.st_mtime);
+	size = static_cast<uint64_t>(st.st_size);
+	return true;
+}
+
+static uint64_t hashSource(const char* file)
+{
+	std::ifstream stream(file, std::ios::binary);
+	std::vector<char> contents((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+	return HashBytes(contents.data(), contents.size());
+}
+
+static std::string entryPathFor(const char* file)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.tex", static_cast<unsigned long long>(HashBytes(file, strlen(file))));
+	return std::string(TextureCache::Directory) + "/" + name;
+}
+
+TextureImage::TextureImage()
+	: Width(0), Height(0), Channels(0), MipLevels(0), RowAlignment(ROW_ALIGNMENT), Pixels(nullptr), mapping(nullptr), mappingSize(0)
+{
+}
+
+TextureImage::~TextureImage()
+{
+	this->Release();
+}
+
+void TextureImage::Release()
+{
+	if (this->mapping != nullptr)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(this->mapping);
+#else
+		munmap(this->mapping, this->mappingSize);
+#endif
+		this->mapping = nullptr;
+	}
+	this->owned.clear();
+	this->owned.shrink_to_fit();
+	this->Pixels = nullptr;
+}
+
+// prints a problem, or appends it to messages when the caller prints them later from its own thread
+static void report(std::string* messages, const std::string& line)
+{
+	if (messages)
+		messages->append(line).append("\n");
+	else
+		std::cout << line << std::endl;
+}
+
+// maps a whole file read-only; returns nullptr if it does not exist or is empty
+static void* mapFile(const char* path, size_t& size)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return nullptr;
+	LARGE_INTEGER fileSize;
+	void* view = nullptr;
+	if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+	{
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping != NULL)
+		{
+			view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping); // the view keeps the mapping alive
+		}
+		size = static_cast<size_t>(fileSize.QuadPart);
+	}
+	CloseHandle(file);
+	return view;
+#else
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return nullptr;
+	struct stat st;
+	void* view = nullptr;
+	if (fstat(fd, &st) == 0 && st.st_size > 0)
+	{
+		view = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (view == MAP_FAILED)
+			view = nullptr;
+		size = static_cast<size_t>(st.st_size);
+	}
+	close(fd);
+	return view;
+#endif
+}
+
+bool TextureCache::Load(const char* file, bool alpha, bool mipmaps, TextureImage& image, bool& hit, std::string* messages)
+{
+	std::string entryPath = entryPathFor(file);
+	hit = openEntry(entryPath.c_str(), file, alpha, mipmaps, image);
+	if (hit)
+		return true;
+	return buildEntry(entryPath.c_str(), file, alpha, mipmaps, image, messages);
+}
+
+bool TextureCache::openEntry(const char* entryPath, const char* file, bool alpha, bool mipmaps, TextureImage& image)
+{
+	uint64_t sourceTime, sourceSize;
+	if (!statSource(file, sourceTime, sourceSize))
+		return false;
+	size_t size = 0;
+	void* view = mapFile(entryPath, size);
+	if (view == nullptr)
+		return false;
+	image.mapping = view;
+	image.mappingSize = size;
+
+	const TextureCacheHeader* header = static_cast<const TextureCacheHeader*>(view);
+	bool valid = size >= sizeof(TextureCacheHeader)
+		&& header->Magic == CACHE_MAGIC && header->Version == CACHE_VERSION
+		&& header->Channels == (alpha ? 4u : 3u) && header->Mipmapped == (mipmaps ? 1u : 0u)
+		&& header->RowAlignment == ROW_ALIGNMENT && header->SourceSize == sourceSize
+		&& size == sizeof(TextureCacheHeader) + imageSize(header->Width, header->Height, header->Channels, header->MipLevels);
+	if (valid && header->SourceTime != sourceTime)
+	{
+		// the source was touched; only rebuild if its contents actually changed
+		valid = header->SourceHash == hashSource(file);
+		if (valid)
+		{
+			std::fstream entry(entryPath, std::ios::binary | std::ios::in | std::ios::out);
+			entry.seekp(offsetof(TextureCacheHeader, SourceTime));
+			entry.write(reinterpret_cast<const char*>(&sourceTime), sizeof(sourceTime));
+		}
+	}
+	if (!valid)
+	{
+		image.Release();
+		return false;
+	}
+	image.Width = header->Width;
+	image.Height = header->Height;
+	image.Channels = header->Channels;
+	image.MipLevels = header->MipLevels;
+	image.RowAlignment = header->RowAlignment;
+	image.Pixels = static_cast<const unsigned char*>(view) + sizeof(TextureCacheHeader);
+	return true;
+}
+
+bool TextureCache::buildEntry(const char* entryPath, const char* file, bool alpha, bool mipmaps, TextureImage& image,
+	std::string* messages)
+{
+	int width, height;
+	unsigned char* data = ResourceManager::DecodeImage(file, alpha, width, height, messages);
+	if (data == nullptr)
+		return false;
+	unsigned int channels = alpha ? 4 : 3;
+	unsigned int levels = 1;
+	if (mipmaps)
+		while ((std::max(width, height) >> levels) > 0)
+			++levels;
+
+	// copy level 0 with padded rows, then box filter each level from the previous one
+	image.owned.resize(imageSize(width, height, channels, levels));
+	unsigned char* level = image.owned.data();
+	size_t pitch = rowPitch(width, channels);
+	for (int y = 0; y < height; ++y)
+		memcpy(level + y * pitch, data + static_cast<size_t>(y) * width * channels, static_cast<size_t>(width) * channels);
+	ResourceManager::FreeImage(data);
+	unsigned int w = width, h = height;
+	for (unsigned int i = 1; i < levels; ++i)
+	{
+		unsigned int nw = std::max(1u, w / 2), nh = std::max(1u, h / 2);
+		size_t npitch = rowPitch(nw, channels);
+		unsigned char* next = level + pitch * h;
+		for (unsigned int y = 0; y < nh; ++y)
+			for (unsigned int x = 0; x < nw; ++x)
+				for (unsigned int c = 0; c < channels; ++c)
+				{
+					unsigned int x0 = std::min(x * 2, w - 1), x1 = std::min(x * 2 + 1, w - 1);
+					unsigned int y0 = std::min(y * 2, h - 1), y1 = std::min(y * 2 + 1, h - 1);
+					unsigned int sum = level[y0 * pitch + x0 * channels + c] + level[y0 * pitch + x1 * channels + c]
+						+ level[y1 * pitch + x0 * channels + c] + level[y1 * pitch + x1 * channels + c];
+					next[y * npitch + x * channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+				}
+		level = next;
+		pitch = npitch;
+		w = nw;
+		h = nh;
+	}
+	image.Width = width;
+	image.Height = height;
+	image.Channels = channels;
+	image.MipLevels = levels;
+	image.RowAlignment = ROW_ALIGNMENT;
+	image.Pixels = image.owned.data();
+
+	// write to a temporary file first so a crash never leaves a truncated entry behind
+	TextureCacheHeader header = {};
+	header.Magic = CACHE_MAGIC;
+	header.Version = CACHE_VERSION;
+	uint64_t sourceTime = 0, sourceSize = 0;
+	statSource(file, sourceTime, sourceSize);
+	header.SourceTime = sourceTime;
+	header.SourceSize = sourceSize;
+	header.SourceHash = hashSource(file);
+	header.Width = width;
+	header.Height = height;
+	header.Channels = channels;
+	header.MipLevels = levels;
+	header.RowAlignment = ROW_ALIGNMENT;
+	header.Mipmapped = mipmaps ? 1 : 0;
+	MakeDirectories(Directory);
+	std::string tempPath = std::string(entryPath) + ".tmp";
+	{
+		std::ofstream entry(tempPath.c_str(), std::ios::binary | std::ios::trunc);
+		entry.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		entry.write(reinterpret_cast<const char*>(image.owned.data()), image.owned.size());
+		if (!entry)
+		{
+			report(messages, "WARNING::TEXTURE_CACHE: Failed to write " + tempPath);
+			return true; // the decoded image is still usable
+		}
+	}
+	// if another writer got there first, the entry is rebuilt next time should theirs be stale
+	if (!CommitCacheFile(tempPath, entryPath))
+		report(messages, "WARNING::TEXTURE_CACHE: Failed to replace " + std::string(entryPath));
+	return true;
+}